@@ -1,8 +1,19 @@
 #pragma once
 
-#define AUDIO_SAMPLES 1024 
+#define AUDIO_SAMPLES 512
 #define AUDIO_CHANNELS 2
-#define SAMPLE_RATE 44100 
+#define SAMPLE_RATE 48000
+#define MAX_SAMPLE_RATE 96000
+
+// T-cycles per internal mix sample (131072 Hz), resampled to the output rate
+#define MIX_DIVIDER 32
+
+// Audio buffer between the APU and the audio callback (interleaved samples, power of two)
+#define AUDIO_BUFFER_SIZE 8192
+
+// Maximum output rate adjustment to keep the buffer half full (0.5%)
+#define AUDIO_MAX_RATE_DELTA 0.005f
+#define AUDIO_RATE_CONTROL_INTERVAL 256
 
 #define CHANNEL_SQUARE_1 0
 #define CHANNEL_SQUARE_2 1
@@ -10,7 +21,6 @@
 #define CHANNEL_NOISE 3
 
 // Clock Dividers
-#define DOWNSAMPLE_DIVIDER (CLOCK_SPEED / SAMPLE_RATE)
 #define FRAME_SEQUENCER_DIVIDER (CLOCK_SPEED / 512)
 
 // Audio Registers
@@ -95,5 +105,7 @@
 
 void init_apu(GameBoy *);
 void reset_apu(GameBoy *);
+bool set_sample_rate(GameBoy *, int);
 void update_apu(GameBoy *);
+bool is_audio_starved(GameBoy *);
 void audio_register_write(GameBoy *, uint16_t, uint8_t);
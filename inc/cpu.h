@@ -1,6 +1,7 @@
 #pragma once
 
 #define CPU_STEP 4
+#define MAX_STEP (UINT16_MAX & ~(CPU_STEP - 1)) // Longest merged step, a multiple of a step
 #define PROGRAM_START 0x100
 
 // Shortcut Macros
@@ -12,8 +13,11 @@
 #define READ16(addr) read_short(gb, (addr), true)
 #define WRITE16(addr, value) write_short(gb, (addr), (value), true)
 
-#define FSET(flag, value) set_flag(gb, flag, value)
-#define FGET(flag) get_flag(gb, flag) 
+#define FSET(flag, value) REG(F) = (REG(F) & ~(1 << (flag))) | (!!(value) << (flag))
+#define FGET(flag) ((REG(F) >> (flag)) & 1)
+
+// Value of F with every flag set at once, each flag is 0 or 1
+#define FLAGS(z, n, h, c) (((z) << FLAG_ZERO) | ((n) << FLAG_SUBTRACT) | ((h) << FLAG_HALFCARRY) | ((c) << FLAG_CARRY))
 
 #define PUSH8(val) stack_push_byte(gb, val)
 #define POP8() stack_pop_byte(gb)
@@ -77,6 +81,7 @@ Instruction;
 
 void reset_cpu(GameBoy *gb);
 Instruction find_instr(GameBoy *, uint16_t);
+Instruction decode_instr(const uint8_t *);
 void execute_instr(GameBoy *);
 
 void stack_push_byte(GameBoy *, uint8_t);
@@ -86,8 +91,10 @@ uint16_t stack_pop_short(GameBoy *);
 uint8_t stack_peek_byte(GameBoy *);
 uint16_t stack_peek_short(GameBoy *);
 
-void set_flag(GameBoy *, uint8_t, uint8_t);
-uint8_t get_flag(GameBoy *, uint8_t);
-
 void check_interrupts(GameBoy *);
 void update_timer(GameBoy *);
+void reset_divider(GameBoy *);
+void set_timer_control(GameBoy *, uint8_t);
+uint8_t read_divider(const GameBoy *);
+uint16_t next_event(GameBoy *);
+uint16_t next_divider_event(const GameBoy *);
@@ -0,0 +1,170 @@
+#pragma once
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "debugger/emulator.h"
+#include "debugger/queue.h"
+
+
+// Runs the emulator on its own thread
+// The UI sends commands through a queue and reads the snapshots the core publishes, never the live state
+class Core final {
+    public:
+        struct Breakpoint {
+            uint16_t address;
+            std::optional<uint16_t> bank; // Only for the switchable ROM bank, any bank if empty
+
+            bool operator==(const Breakpoint &) const;
+        };
+
+        struct Watchpoint {
+            uint16_t start;
+            uint16_t end;
+            std::optional<uint16_t> bank; // Bank of a switchable region, any bank if empty
+            bool on_read;
+            bool on_write;
+            std::optional<uint8_t> value; // Only hits when this value is read or written
+
+            bool operator==(const Watchpoint &) const;
+        };
+
+        struct WatchpointHit {
+            uint16_t address;
+            uint16_t bank;
+            uint8_t value;
+            bool is_write;
+        };
+
+        // When the bytes changed by the program are forgotten
+        enum class ChangeReset { OnResume, EveryFrame };
+
+        // Normal runs at the GameBoy's rate, paced by the audio device or by the clock without one
+        enum class Speed { Normal, Unthrottled };
+
+        // Copy of the emulator between two instructions, the memory pointers point into the copied regions
+        // Only for reading with the C macros, the PPU and APU buffers are still shared with the core
+        class State final {
+            public:
+                State() = default;
+                State(const State &) = delete;
+                State &operator=(const State &) = delete;
+
+                void capture(const Emulator::GameBoy &);
+                [[nodiscard]] Emulator::GameBoy *gb();
+
+                bool is_paused = true;
+                uint32_t stop_count = 0; // Incremented every time the core stops by itself
+                std::optional<WatchpointHit> last_watchpoint_hit;
+
+            private:
+                Emulator::GameBoy _gb {};
+
+                std::array<std::array<uint8_t, VRAM_BANK_SIZE>, VRAM_BANK_COUNT> _vram {};
+                std::array<std::array<uint8_t, WRAM_BANK_SIZE>, WRAM_BANK_COUNT> _wram {};
+                std::array<uint8_t, EXTRAM_BANK_SIZE> _extram {};
+                std::array<uint8_t, OAM_SIZE> _oam {};
+                std::array<uint8_t, IO_SIZE> _io {};
+                std::array<uint8_t, HRAM_SIZE> _hram {};
+                uint8_t _ier = 0;
+                std::vector<Emulator::TimelineEvent> _timeline;
+                std::array<uint8_t, (UINT16_MAX + 1) / 8> _changed {};
+
+                std::array<uint8_t *, VRAM_BANK_COUNT> _vram_banks {};
+                std::array<uint8_t *, WRAM_BANK_COUNT> _wram_banks {};
+        };
+
+        struct SetPaused { bool value; };
+        struct SetNextStop { std::optional<uint16_t> fall_thru; std::optional<uint16_t> jump; };
+        struct Reset {};
+        struct AddBreakpoint { Breakpoint breakpoint; };
+        struct RemoveBreakpoint { Breakpoint breakpoint; };
+        struct AddWatchpoint { Watchpoint watchpoint; };
+        struct RemoveWatchpoint { Watchpoint watchpoint; };
+        struct WriteMemory { uint16_t address; uint8_t value; bool is_program; };
+        struct SetChangeReset { ChangeReset value; };
+        struct SetSpeed { Speed value; };
+
+        // Any other change, applied to the live state on the core thread
+        using Edit = std::function<void(Emulator::GameBoy *)>;
+
+        using Command = std::variant<
+            SetPaused, SetNextStop, Reset, AddBreakpoint, RemoveBreakpoint,
+            AddWatchpoint, RemoveWatchpoint, WriteMemory, SetChangeReset, SetSpeed, Edit
+        >;
+
+        explicit Core(std::shared_ptr<Emulator::GameBoy>);
+
+        void start();
+        void stop();
+        [[nodiscard]] bool is_running() const;
+
+        void push(Command &&);
+        State &take_state();
+
+    private:
+        static constexpr size_t COMMAND_CAPACITY = 1024;
+        static constexpr uint8_t STATE_READY = 0x80;
+
+        std::shared_ptr<Emulator::GameBoy> _gb;
+        SDL_Thread *_thread;
+        std::atomic<bool> _is_running;
+
+        Queue<Command, COMMAND_CAPACITY> _commands;
+
+        // Triple buffered like the frames, the UI always holds a complete snapshot
+        std::array<State, 3> _states;
+        uint8_t _back_state; // Owned by the core thread
+        uint8_t _front_state; // Owned by the UI thread
+        std::atomic<uint8_t> _ready_state; // Index of the last published state (| STATE_READY when not yet taken)
+
+        // Everything below is only touched by the core thread once started
+        bool _is_paused;
+        uint32_t _stop_count;
+
+        // A conditional jump has two possible branches
+        std::optional<uint16_t> _next_stop_fall_thru;
+        std::optional<uint16_t> _next_stop_jump;
+
+        // Flags per address so the check after every instruction is a single lookup
+        static constexpr uint8_t BREAKPOINT_ANY_BANK = 0x1;
+        static constexpr uint8_t BREAKPOINT_BANKED = 0x2;
+
+        std::vector<Breakpoint> _breakpoints;
+        std::array<uint8_t, 0x10000> _breakpoint_flags;
+        std::unordered_set<uint32_t> _banked_breakpoints; // Bank in the upper 16 bits
+
+        // The conditions are checked by the handler, the emulator only tests the per address flags
+        std::vector<Watchpoint> _watchpoints;
+        std::optional<WatchpointHit> _last_watchpoint_hit;
+        bool _is_watchpoint_hit;
+
+        ChangeReset _change_reset;
+
+        Speed _speed;
+        uint64_t _frame_duration; // In performance counter ticks
+        uint64_t _next_frame;
+
+        static int emulate(void *);
+        [[nodiscard]] bool is_frame_due();
+        void run_frame();
+        void stop_at_pc();
+        bool apply_commands();
+        void apply(Command &);
+        void publish();
+
+        void set_paused(bool);
+        [[nodiscard]] bool is_breakpoint(uint16_t) const;
+        void update_breakpoint_flags(uint16_t);
+        void update_watch_flags();
+
+        static void watch_handler(void *, uint16_t, uint8_t, bool);
+};
@@ -3,6 +3,7 @@
 #define SDL_MAIN_HANDLED
 #include <SDL.h>
 #include <vector>
+#include <array>
 #include <map>
 #include <memory>
 #include <optional>
@@ -12,6 +13,9 @@
 #include "imgui/imgui_internal.h"
 
 #include "debugger/emulator.h"
+#include "debugger/core.h"
+#include "debugger/symbols.h"
+#include "debugger/tile_cache.h"
 #include "debugger/window.h"
 #include "debugger/menubar.h"
 
@@ -19,23 +23,45 @@
 class Debugger final {
     public:
         enum class WindowId {
-            Breakpoints, CartInfo, Controls, Disassembly, Framebuffer, IO, Memory, Palettes, Registers, Serial, Stack
+            Breakpoints, CartInfo, Controls, Disassembly, Framebuffer, IO, Memory, Palettes, Profiler, Registers, Serial, Sprites, Stack, Tilemap, Tiles, Timeline, Trace
         };
 
+        using Breakpoint = Core::Breakpoint;
+        using Watchpoint = Core::Watchpoint;
+        using WatchpointHit = Core::WatchpointHit;
+        using ChangeReset = Core::ChangeReset;
+        using Speed = Core::Speed;
+
         explicit Debugger(const char *);
         ~Debugger();
 
         std::shared_ptr<Emulator::GameBoy> &gb();
+        [[nodiscard]] Core::State &state() const;
+
+        void write_memory(uint16_t, uint8_t, bool = false);
+        void edit(Core::Edit &&);
+        void reset();
+        void quit();
 
-        [[nodiscard]] const std::vector<uint16_t> &breakpoints() const;
+        [[nodiscard]] const std::vector<Breakpoint> &breakpoints() const;
         [[nodiscard]] bool is_breakpoint(uint16_t) const;
-        void add_breakpoint(uint16_t);
-        void remove_breakpoint(uint16_t);
+        void add_breakpoint(uint16_t, std::optional<uint16_t> = std::nullopt);
+        void remove_breakpoint(const Breakpoint &);
+
+        [[nodiscard]] const std::vector<Watchpoint> &watchpoints() const;
+        [[nodiscard]] const std::optional<WatchpointHit> &last_watchpoint_hit() const;
+        void add_watchpoint(const Watchpoint &);
+        void remove_watchpoint(const Watchpoint &);
 
         [[nodiscard]] bool is_paused() const;
         void set_paused(bool);
 
         void set_next_stop(std::optional<uint16_t>, std::optional<uint16_t>);
+        void set_change_reset(ChangeReset);
+        void set_speed(Speed);
+
+        [[nodiscard]] const Symbols &symbols() const;
+        TileCache &tiles();
 
         void run();
         void render();
@@ -52,13 +78,16 @@ class Debugger final {
         SDL_Window *_window;
         SDL_GLContext _gl_context;
 
-        bool _is_paused;
+        Core _core;
+        Core::State *_state; // Latest snapshot taken from the core, refreshed every UI frame
+        uint32_t _stop_count;
 
-        // A conditional jump has two possible branches
-        std::optional<uint16_t> _next_stop_fall_thru;
-        std::optional<uint16_t> _next_stop_jump;
+        // Mirrors of the core's lists for the windows
+        std::vector<Breakpoint> _breakpoints;
+        std::vector<Watchpoint> _watchpoints;
 
-        std::vector<uint16_t> _breakpoints;
+        Symbols _symbols;
+        TileCache _tiles;
 
         MenuBar _menu = MenuBar(*this);
         std::map<WindowId, std::shared_ptr<Window>> _windows;
@@ -67,6 +96,7 @@ class Debugger final {
         void init_gl();
         void init_imgui() const;
         void load_symbols(const char *);
+        void take_state();
 
-        void handle_event(SDL_Event) const;
+        void handle_event(SDL_Event);
 };
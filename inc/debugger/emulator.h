@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdio>
 
 namespace Emulator 
 {
@@ -9,7 +10,14 @@ namespace Emulator
         #include "mbc.h"
         #include "cart.h"
         #include "ppu.h"
+        #include "tile.h"
         #include "apu.h"
         #include "input.h"
+        #include "trace.h"
+        #include "profiler.h"
+        #include "timeline.h"
+        #include "idle.h"
+        #include "icache.h"
+        #include "jit.h"
     }
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <optional>
+#include <cstddef>
+
+
+// Lock-free queue for one producer thread and one consumer thread
+// The positions are free running counters, the capacity must be a power of two
+template<typename T, size_t Capacity>
+class Queue final {
+    static_assert((Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+    public:
+        // Returns false and leaves the value untouched when the queue is full
+        bool push(T &&value) {
+
+            const auto write_position = _write_position.load(std::memory_order_relaxed);
+
+            if(write_position - _read_position.load(std::memory_order_acquire) == Capacity)
+                return false;
+
+            _items[write_position & (Capacity - 1)] = std::move(value);
+            _write_position.store(write_position + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::optional<T> pop() {
+
+            const auto read_position = _read_position.load(std::memory_order_relaxed);
+
+            if(read_position == _write_position.load(std::memory_order_acquire))
+                return std::nullopt;
+
+            std::optional<T> value = std::move(_items[read_position & (Capacity - 1)]);
+            _read_position.store(read_position + 1, std::memory_order_release);
+            return value;
+        }
+
+    private:
+        std::array<T, Capacity> _items {};
+
+        // Kept on separate cache lines so the two threads don't share one
+        alignas(64) std::atomic<size_t> _read_position { 0 };
+        alignas(64) std::atomic<size_t> _write_position { 0 };
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Symbols of a .sym file (bank:address name), sorted by bank then address
+class Symbols final {
+    public:
+        struct Symbol {
+            uint16_t bank; // 0 for the fixed regions
+            uint16_t address;
+            std::string name;
+        };
+
+        using Iterator = std::vector<Symbol>::const_iterator;
+
+        bool load(const std::string &);
+        void add(uint16_t, uint16_t, const std::string &);
+
+        [[nodiscard]] const std::vector<Symbol> &all() const;
+        [[nodiscard]] std::pair<Iterator, Iterator> range(uint16_t, uint16_t, uint32_t) const;
+        [[nodiscard]] const Symbol *nearest(uint16_t, uint16_t) const;
+        [[nodiscard]] std::string name(uint16_t, uint16_t, bool = true) const;
+
+    private:
+        std::vector<Symbol> _symbols;
+
+        [[nodiscard]] Iterator lower_bound(uint16_t, uint32_t) const;
+        static uint32_t key(uint16_t, uint32_t);
+        static int region(uint16_t);
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "imgui/imgui.h"
+#include "debugger/emulator.h"
+
+
+// Tiles of both VRAM banks decoded into a texture, one texture per palette
+// Only the tiles written since the texture was last used are decoded and uploaded again
+class TileCache final {
+    public:
+        using Palette = std::array<uint32_t, 4>;
+
+        // The banks are side by side, 16 tiles per row
+        static constexpr uint32_t TILES_PER_ROW = 16;
+        static constexpr uint32_t WIDTH = TILES_PER_ROW * TILE_WIDTH * VRAM_BANK_COUNT;
+        static constexpr uint32_t HEIGHT = VRAM_TILE_COUNT / TILES_PER_ROW * TILE_WIDTH;
+
+        TileCache() = default;
+        TileCache(const TileCache &) = delete;
+        TileCache &operator=(const TileCache &) = delete;
+        ~TileCache();
+
+        ImTextureID texture(const Emulator::GameBoy *, const Palette &);
+        [[nodiscard]] static std::pair<ImVec2, ImVec2> uv(uint8_t, uint16_t, bool = false, bool = false);
+
+        [[nodiscard]] static Palette bg_palette(Emulator::GameBoy *, uint8_t);
+        [[nodiscard]] static Palette obj_palette(Emulator::GameBoy *, uint8_t);
+
+    private:
+        // Enough for every CGB palette, the least recently used page is replaced past this
+        static constexpr size_t MAX_PAGES = 20;
+
+        struct Page {
+            Palette palette;
+            GLuint texture_id;
+            uint32_t last_use;
+            std::array<uint32_t, VRAM_BANK_COUNT * VRAM_TILE_COUNT> versions;
+            std::vector<uint32_t> pixels;
+        };
+
+        std::vector<Page> _pages;
+        uint32_t _use_count = 0;
+
+        Page &page(const Emulator::GameBoy *, const Palette &);
+        static void update(Page &, const Emulator::GameBoy *);
+        static void decode_tile(const Emulator::GameBoy *, const Palette &, uint8_t, uint16_t, uint32_t *);
+};
@@ -1,7 +1,7 @@
 #pragma once
 
-// Create local pointer named gb to use the C macros
-#define INIT_GB_CTX() static auto gb = debugger().gb().get()
+// Create local pointer named gb to the latest state to use the C macros
+#define INIT_GB_CTX() auto *const gb = debugger().state().gb()
 
 
 class Debugger;
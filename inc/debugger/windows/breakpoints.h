@@ -9,5 +9,8 @@ namespace Windows {
             void render() override;
 
             [[nodiscard]] const char *title() const override;
+
+        private:
+            void render_watchpoints();
     };
 }
@@ -10,6 +10,8 @@ namespace Windows {
             [[nodiscard]] const char *title() const override;
 
         private:
+            int _speed;
+
             void step_into();
             void step_over();
             void run_to_next() const;
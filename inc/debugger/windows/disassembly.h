@@ -1,7 +1,7 @@
 #pragma once
-#include <map>
+#include <vector>
 #include <optional>
-#include <string>
+#include <utility>
 #include "debugger/window.h"
 
 namespace Windows {
@@ -13,19 +13,50 @@ namespace Windows {
             [[nodiscard]] const char *title() const override;
 
             void scroll_to_address(uint16_t);
-            void add_label(uint16_t, const std::string &);
 
         private:
+            // Lines are indexed per region so a bank switch or a write to RAM only re-decodes that region
+            struct Segment {
+                uint16_t start;
+                uint16_t end;
+                bool is_executable;
+                bool is_rom;
+
+                const uint8_t *memory = nullptr; // Backing memory the index was built from
+                std::vector<uint8_t> snapshot {}; // Contents the index was built from
+                std::vector<uint16_t> lines {}; // Address of every line, sorted
+                size_t first_line = 0;
+            };
+
+            // Cartridge header fields, shown as labels along with the symbols
+            static constexpr size_t HEADER_LABEL_COUNT = 7;
+            static const std::pair<uint16_t, const char *> header_labels[HEADER_LABEL_COUNT];
+
             std::optional<uint16_t> _address_to_scroll_to;
-            std::map<uint16_t, const std::string> _labels;
+            size_t _selected_label; // Header labels first, then the symbols
+
+            std::vector<Segment> _segments;
+            size_t _line_count;
+
+            void update_index();
+            bool update_segment(Segment &);
+            void decode_segment(Segment &, uint16_t, uint16_t);
+            [[nodiscard]] const uint8_t *segment_memory(const Segment &) const;
+            [[nodiscard]] uint16_t line_length(uint16_t) const;
+            [[nodiscard]] const Segment &segment_of_address(uint16_t) const;
 
             static void draw_region_prefix(uint16_t addr) ;
+            void draw_labels(uint16_t) const;
             void draw_instr_line(uint16_t, const Emulator::Instruction &);
             void draw_data_line(uint16_t) const;
 
             static bool is_executable(uint16_t) ;
             static const char *get_region_label(uint16_t) ;
-            [[nodiscard]] uint16_t address_of_nth_line(uint16_t, size_t) const;
-            [[nodiscard]] size_t line_count(uint16_t, uint16_t) const;
+            [[nodiscard]] uint16_t address_of_line(size_t) const;
+            [[nodiscard]] size_t line_of_address(uint16_t) const;
+            [[nodiscard]] size_t labels_before(uint16_t) const;
+
+            [[nodiscard]] const char *label_name(size_t) const;
+            [[nodiscard]] uint16_t label_address(size_t) const;
     };
 }
@@ -13,5 +13,8 @@ namespace Windows {
         private:
             void draw_values(const char **, const uint16_t *, int) const;
             void draw_registers(const char **, uint16_t, const uint8_t *, int) const;
+            void draw_channel_enabled(int) const;
+
+            static bool *channel_enabled(Emulator::GameBoy *, int);
     };
 }
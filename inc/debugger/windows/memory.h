@@ -1,4 +1,5 @@
 #pragma once
+#include <optional>
 #include <imgui_club/imgui_memory_editor/imgui_memory_editor.h>
 #include "debugger/window.h"
 
@@ -14,9 +15,24 @@ namespace Windows {
             static constexpr size_t REGION_COUNT = 9;
             MemoryEditor _editor;
 
+            static constexpr float HEATMAP_CELL_SIZE = 12.0f;
+            static constexpr float HEATMAP_MARGIN = 40.0f;
+
             size_t _selected_idx;
+            int _change_reset;
+            bool _is_heatmap_shown;
+
+            // The editor shows the state, its writes are sent to the core
+            static Memory *_instance;
+            static void write_handler(uint8_t *, size_t, uint8_t);
+            static bool highlight_handler(const uint8_t *, size_t);
+
+            void render_tracking();
+            void render_heatmap();
+
+            [[nodiscard]] const uint8_t *region(size_t) const;
+            [[nodiscard]] std::optional<size_t> region_of(uint16_t) const;
 
-            const uint8_t *_regions[REGION_COUNT] = { debugger().gb()->mmu.rom00, debugger().gb()->mmu.romNN, debugger().gb()->mmu.vram, debugger().gb()->mmu.extram, debugger().gb()->mmu.wram00, debugger().gb()->mmu.wramNN, debugger().gb()->mmu.oam, debugger().gb()->mmu.io, debugger().gb()->mmu.hram };
             const char *_labels[REGION_COUNT] = { "ROM 00", "ROM NN", "VRAM", "EXTRAM", "WRAM 00", "WRAM NN", "OAM", "IO", "HRAM" };
             const size_t _sizes[REGION_COUNT] = { ROM_BANK_SIZE, ROM_BANK_SIZE, VRAM_BANK_SIZE, EXTRAM_BANK_SIZE, WRAM_BANK_SIZE, WRAM_BANK_SIZE, OAM_SIZE, IO_SIZE, HRAM_SIZE };
             const size_t _offsets[REGION_COUNT] = { ROM00_START, ROMNN_START, VRAM_START, EXTRAM_START, WRAM00_START, WRAMNN_START, OAM_START, IO_START, HRAM_START };
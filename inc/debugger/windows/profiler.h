@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include "debugger/window.h"
+
+namespace Windows {
+    class Profiler final : public Window {
+        public:
+            explicit Profiler(Debugger &);
+
+            void render() override;
+            [[nodiscard]] const char *title() const override;
+
+        private:
+            // UI frames between two snapshots while profiling
+            static constexpr uint32_t REFRESH_FRAMES = 30;
+
+            struct Sample {
+                uint16_t bank;
+                uint16_t address;
+                uint64_t cycles;
+            };
+
+            // Copied from the emulator on the core thread
+            struct Snapshot {
+                uint64_t cycles = 0;
+                uint64_t halted_cycles = 0;
+                std::vector<Sample> samples;
+                std::vector<Emulator::ProfileNode> nodes;
+            };
+
+            // Every node of a routine in the call tree
+            struct Function {
+                std::string name;
+                uint16_t bank;
+                uint16_t address;
+                uint32_t calls;
+                uint64_t self_cycles;
+                uint64_t total_cycles; // Including the routines it called
+            };
+
+            // Executed addresses grouped by the symbol before them
+            struct SymbolCycles {
+                std::string name;
+                uint64_t cycles;
+            };
+
+            Snapshot _snapshot;
+            Snapshot _pending;
+            std::atomic<bool> _is_pending_ready;
+            bool _is_requested;
+            uint32_t _frames_since_request;
+
+            std::vector<std::string> _node_names;
+            std::vector<uint64_t> _node_cycles; // Including the routines called
+            std::vector<std::vector<uint32_t>> _children; // Most expensive first
+            uint32_t _max_depth;
+            uint32_t _zoom_node;
+
+            std::vector<Function> _functions;
+            std::vector<SymbolCycles> _symbols;
+            bool _is_sort_dirty;
+
+            void request_snapshot();
+            void take_snapshot();
+            void build_call_tree();
+            void build_functions();
+            void build_symbols();
+
+            void render_functions();
+            void render_symbols();
+            void render_flamegraph();
+            void draw_node(uint32_t, float, float, float, uint32_t);
+
+            [[nodiscard]] float percent(uint64_t) const;
+    };
+}
@@ -8,5 +8,8 @@ namespace Windows {
 
             void render() override;
             [[nodiscard]] const char *title() const override;
+
+        private:
+            static uint16_t *cpu_register(Emulator::GameBoy *, int);
     };
 }
@@ -2,6 +2,7 @@
 #include <sstream>
 #include <cstdint>
 #include "debugger/window.h"
+#include "debugger/queue.h"
 
 namespace Windows {
     class Serial final : public Window {
@@ -14,6 +15,9 @@ namespace Windows {
             static void serial_write_handler(uint8_t);
 
         private:
+            static constexpr size_t PENDING_CAPACITY = 4096;
+
             static std::stringstream _buffer;
+            static Queue<uint8_t, PENDING_CAPACITY> _pending; // Written on the core thread, drained when rendering
     };
 }
@@ -0,0 +1,21 @@
+#pragma once
+#include "debugger/window.h"
+
+namespace Windows {
+    class Sprites final : public Window {
+        public:
+            explicit Sprites(Debugger &);
+
+            void render() override;
+            [[nodiscard]] const char *title() const override;
+
+        private:
+            static constexpr uint8_t SPRITE_COUNT = 40;
+            static constexpr float SCALE = 3.0f;
+
+            bool _is_hidden_shown;
+
+            void render_sprite(Emulator::GameBoy *, uint8_t, bool);
+            void render_screen(Emulator::GameBoy *, bool);
+    };
+}
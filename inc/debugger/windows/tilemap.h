@@ -0,0 +1,35 @@
+#pragma once
+#include <array>
+#include "debugger/window.h"
+
+namespace Windows {
+    class Tilemap final : public Window {
+        public:
+            explicit Tilemap(Debugger &);
+
+            void render() override;
+            [[nodiscard]] const char *title() const override;
+
+        private:
+            static constexpr uint32_t MAP_SIZE = 32; // Tiles per side
+            static constexpr uint32_t MAP_WIDTH = MAP_SIZE * TILE_WIDTH;
+            static constexpr uint8_t PALETTE_COUNT = 8;
+
+            // The first two follow LCDC
+            enum Map { BackgroundMap, WindowMap, Map9800, Map9C00 };
+
+            int _map;
+            bool _is_grid_shown;
+            bool _is_viewport_shown;
+
+            // Textures of the palettes used this frame
+            std::array<ImTextureID, PALETTE_COUNT> _textures;
+
+            [[nodiscard]] uint16_t map_start(Emulator::GameBoy *) const;
+            ImTextureID texture(Emulator::GameBoy *, uint8_t);
+
+            void render_map(Emulator::GameBoy *, ImVec2, float);
+            void render_viewport(Emulator::GameBoy *, ImVec2, float) const;
+            void render_tooltip(Emulator::GameBoy *, ImVec2, float);
+    };
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "debugger/window.h"
+
+namespace Windows {
+    class Tiles final : public Window {
+        public:
+            explicit Tiles(Debugger &);
+
+            void render() override;
+            [[nodiscard]] const char *title() const override;
+
+        private:
+            static constexpr uint8_t PALETTE_COUNT = 8;
+
+            bool _is_obj_palette;
+            uint8_t _palette;
+
+            void render_palette_combo(Emulator::GameBoy *);
+    };
+}
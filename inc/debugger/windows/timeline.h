@@ -0,0 +1,37 @@
+#pragma once
+#include <array>
+#include <optional>
+#include <vector>
+#include "debugger/window.h"
+
+namespace Windows {
+    class Timeline final : public Window {
+        public:
+            explicit Timeline(Debugger &);
+
+            void render() override;
+            [[nodiscard]] const char *title() const override;
+
+        private:
+            static constexpr uint32_t LINE_COUNT = 154;
+            static constexpr uint32_t FIRST_LINE = 144; // A frame ends when V-Blank starts
+            static constexpr uint32_t EVENT_TYPE_COUNT = 6;
+            static constexpr float LINE_HEIGHT = 2.0f;
+            static constexpr float MARGIN = 50.0f;
+
+            std::array<bool, EVENT_TYPE_COUNT> _is_shown;
+            std::vector<uint32_t> _shown_events;
+            std::optional<uint32_t> _selected;
+            bool _should_scroll;
+
+            void render_raster(const Emulator::TimelineEvent *, uint32_t);
+            void render_events(const Emulator::TimelineEvent *);
+            void fill_span(uint32_t, uint32_t, uint32_t, float, float, float) const;
+
+            static uint32_t time_of(const Emulator::TimelineEvent &);
+            static const char *type_name(uint8_t);
+            static uint32_t type_colour(uint8_t);
+            static uint32_t mode_colour(uint16_t);
+            static const char *register_name(uint16_t);
+    };
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+#include "debugger/window.h"
+
+namespace Windows {
+    class Trace final : public Window {
+        public:
+            explicit Trace(Debugger &);
+
+            void render() override;
+            [[nodiscard]] const char *title() const override;
+
+        private:
+            enum class SearchMode {
+                Address, Instruction
+            };
+
+            std::vector<Emulator::TraceRecord> _records;
+
+            // Decoded on the core thread, swapped in once ready
+            std::vector<Emulator::TraceRecord> _pending;
+            std::atomic<bool> _is_pending_ready;
+            bool _is_requested;
+            uint32_t _stop_count;
+            bool _was_paused;
+
+            std::optional<size_t> _selected;
+            bool _should_scroll;
+
+            SearchMode _search_mode;
+            std::array<char, 64> _search;
+            std::array<char, 256> _trace_path; // Binary trace recorded with --trace
+            std::array<char, 256> _doctor_path; // Text log written from the records
+            std::string _status;
+
+            void request_records();
+            void take_records();
+            void find_next();
+            void load(const char *);
+            void export_doctor(const char *);
+
+            void render_records();
+
+            void format_record(const Emulator::TraceRecord &, char *, size_t) const;
+            static void format_instr(const Emulator::TraceRecord &, char *, size_t);
+    };
+}
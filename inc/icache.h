@@ -0,0 +1,7 @@
+#pragma once
+
+
+void init_icache(GameBoy *);
+const DecodedInstr *fetch_instr(GameBoy *, uint16_t);
+const DecodedInstr *decode_repeated(GameBoy *, uint16_t);
+void invalidate_instr(GameBoy *, uint16_t);
@@ -0,0 +1,17 @@
+#pragma once
+
+// Longest loop looked at, from the branch target to the end of the branch
+#define IDLE_LOOP_MAX_SIZE 16
+
+// Registers an instruction of the loop writes or reads memory through, a bit per operand index (B C D E H L _ A)
+#define IDLE_REG_BC 0x03
+#define IDLE_REG_C 0x02
+#define IDLE_REG_DE 0x0C
+#define IDLE_REG_HL 0x30
+#define IDLE_REG_SP 0x40
+#define IDLE_REG_A 0x80
+
+
+void init_idle_loop(GameBoy *);
+void reset_idle_loop(GameBoy *);
+void update_idle_loop(GameBoy *, uint16_t);
@@ -10,6 +10,16 @@
 #define KEY_LEFT_B 0x2 
 #define KEY_RIGHT_A 0x1 
 
+// Bits of the pressed keys
+#define INPUT_RIGHT 0x01
+#define INPUT_LEFT 0x02
+#define INPUT_UP 0x04
+#define INPUT_DOWN 0x08
+#define INPUT_A 0x10
+#define INPUT_B 0x20
+#define INPUT_SELECT 0x40
+#define INPUT_START 0x80
+
 // Shortcut Macros
 #define KEY_STATE (key.state == SDL_PRESSED) ? true : false
 #define SET_KEY(mask, value, input) ((value) ? ((input) ^= (mask)) : ((input) |= (mask))) 
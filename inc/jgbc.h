@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <SDL.h>
 
 struct GameBoy_s;
@@ -53,11 +54,15 @@ Registers;
 typedef struct {
     bool is_halted;
     bool is_double_speed;
+    bool is_ime_scheduled; // EI enables the interrupts after the next instruction
+    bool is_halt_bug; // HALT with a pending interrupt and IME off, the next opcode is read twice
 
     Registers reg;
-    uint8_t ticks;
-    uint16_t div_clock; // Divider Timer Clock
-    uint16_t cnt_clock; // Timer Counter Clock
+    uint16_t ticks; // A halted step lasts until the next interrupt or PPU mode change
+    uint16_t divider; // Internal counter, DIV is its upper byte
+    uint8_t timer_bit; // Bit of the divider whose falling edges increment TIMA (from TAC)
+    bool is_timer_running;
+    uint8_t pending_interrupts; // IE & IF, updated when either is written
 }
 CPU;
 
@@ -69,15 +74,46 @@ typedef struct {
 }
 Sprite;
 
+// One 8 pixel row of a tile, ready to be decoded into colours
 typedef struct {
-    uint16_t *framebuffer;
+    uint8_t low; // Bit 0 of each colour number (leftmost pixel in bit 7)
+    uint8_t high; // Bit 1 of each colour number
+    const uint32_t *palette; // 4 colours
+}
+TileRow;
+
+// Triple buffering, completed frames are handed to the presenting thread
+// through an atomic swap of the ready index so neither side waits on the other
+// Set up once, resetting or copying the emulator never touches the presenting thread's frame
+typedef struct {
+    uint32_t *buffers[3];
+    uint8_t back; // Owned by the emulation thread
+    uint8_t front; // Owned by the presenting thread
+    SDL_atomic_t ready; // Index of the last completed frame (| FRAME_READY when not yet taken)
+}
+FrameQueue;
+
+typedef struct {
+    uint32_t *framebuffer; // Frame being drawn, packed ABGR8888 (RGBA byte order on little endian)
+    FrameQueue *frames;
     Sprite sprite_buffer[40];
+    bool is_sprite_buffer_dirty; // OAM was written since the buffer was sorted
+
     uint16_t scan_clock;
     uint16_t frame_clock;
 
-    uint16_t bg_palette[32];
+    uint16_t bg_palette[32]; // Raw BGR555 palette data (CGB)
     uint16_t obj_palette[32];
 
+    // Palettes converted to the framebuffer format when they are written
+    uint32_t bg_colours[32];
+    uint32_t obj_colours[32];
+    uint32_t shades[4]; // Monochrome GameBoy shades
+    bool is_colour_corrected;
+
+    // Expands tile rows into 8 colours each (picked at runtime for the host CPU)
+    void (*tile_decoder)(const TileRow *, uint8_t, uint32_t *);
+
     SDL_Window *window;
     SDL_Renderer *renderer;
     SDL_Texture *texture;
@@ -89,8 +125,28 @@ typedef enum {
 }
 HDMAMode;
 
+// What a write to a page does besides storing the value
+typedef enum {
+    PageRAM, // Stored as is (cartridge RAM)
+    PageCode, // Work RAM, the decoded instructions covering the byte are dropped
+    PageROM, // Sent to the MBC
+    PageVRAM, // Marks the tile as changed
+    PageOAM, // Marks the sprite list as changed
+    PageHigh // IO registers, high RAM and IE, each with its own handling
+}
+PageType;
+
+// 256 byte page of the address space, only used for writes
+typedef struct {
+    PageType type;
+    uint8_t **region; // Points to the region's bank pointer, switching banks doesn't touch the table
+    uint16_t offset; // Of the page in the region
+}
+MemoryPage;
+
 typedef struct {
     uint16_t rom_bank;
+    uint16_t rom00_bank; // Only switched by MBC1 in RAM banking mode
     uint8_t ram_bank;
     uint8_t wram_bank;
     uint8_t vram_bank;
@@ -109,6 +165,13 @@ typedef struct {
     uint8_t **wram_banks; // 8x4KB WRAM Banks (GBC Only)
     uint8_t **vram_banks; // 2x8KB VRAM Banks (GBC Only)
 
+    // Incremented on every write to the tile data, the viewers only decode the tiles that changed
+    uint32_t tile_versions[2][384];
+
+    // Indexed by the upper byte of the address
+    // Only valid for the emulator it was set up in, a copied GameBoy still points at the original's banks
+    MemoryPage pages[256];
+
     void (*mbc_handler)(GameBoy *, uint16_t, uint8_t);
 
     struct {
@@ -121,6 +184,23 @@ typedef struct {
     hdma;
 
     void (*serial_write_handler)(const uint8_t);
+
+    // Program reads and writes are only checked against the flags while armed
+    struct {
+        bool is_armed;
+        uint8_t *flags; // WATCH_READ and WATCH_WRITE per address
+        void (*handler)(void *, uint16_t, uint8_t, bool);
+        void *data;
+    }
+    watch;
+
+    // Writes per page and bytes changed since the last clear, only kept while enabled
+    struct {
+        bool is_enabled;
+        uint32_t page_counts[256];
+        uint8_t *changed; // One bit per address
+    }
+    writes;
 }
 MMU;
 
@@ -199,13 +279,31 @@ typedef struct {
 }
 Noise;
 
+typedef struct {
+    void (*filter)(const float *, const float *, const float *, const float *, float, float *);
+    float *coefficients; // RESAMPLER_PHASES + 1 rows of RESAMPLER_TAPS
+    float *history[2]; // Left and right inputs, each stored twice
+    uint8_t position;
+
+    float input_rate;
+    float clock; // Input samples since the last output sample
+    float step; // Input samples between output samples, adjusted to keep the buffer half full
+}
+Resampler;
+
 typedef struct {
     bool enabled;
     SDL_AudioDeviceID device_id;
     SDL_AudioSpec audio_spec;
 
-    float *buffer;
-    uint32_t buffer_position;
+    // Single producer (emulation) single consumer (audio callback) ring buffer
+    // The positions are free running counters of interleaved samples
+    struct {
+        float *data;
+        SDL_atomic_t read_position;
+        SDL_atomic_t write_position;
+    }
+    buffer;
 
     struct {
         uint8_t step;
@@ -213,7 +311,14 @@ typedef struct {
     }
     frame_sequencer;
 
-    uint8_t downsample_clock;
+    // Channel outputs summed over MIX_DIVIDER T-cycles, a box filter ahead of the resampler
+    struct {
+        uint16_t channels[4];
+        uint8_t clock;
+    }
+    mix;
+
+    Resampler resampler;
 
     uint8_t left_volume;
     uint8_t right_volume;
@@ -242,20 +347,175 @@ typedef struct {
 }
 Cart;
 
+// Set by the thread handling the events and read by the emulation
 typedef struct {
-    bool up;
-    bool right;
-    bool down;
-    bool left;
-    bool start;
-    bool select;
-    bool a;
-    bool b;
+    SDL_atomic_t keys; // Pressed keys (INPUT_*)
 }
 Input;
 
+// State before an executed instruction
+typedef struct {
+    uint64_t clock; // T-cycles since the recording started
+    uint16_t pc;
+    uint16_t bank; // Bank mapped at the PC, 0 for the fixed regions
+    uint16_t af;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint16_t sp;
+    uint8_t memory[4]; // Bytes at the PC, the opcode first
+}
+TraceRecord;
+
+typedef struct {
+    uint64_t clock; // Of the first record, which is stored in full
+    uint32_t count;
+    uint32_t size;
+    uint8_t *data; // Delta encoded records
+}
+TraceChunk;
+
+typedef struct {
+    bool is_recording;
+    uint64_t clock;
+
+    TraceChunk *chunks; // TRACE_CHUNK_COUNT chunks, allocated when first recording
+    uint32_t first_chunk;
+    uint32_t chunk_count;
+
+    TraceRecord last; // The next record is encoded against it
+    FILE *file; // Chunks are also written here when they are closed
+}
+Trace;
+
+// Routine entered with a CALL, RST or an interrupt, the first node is the code outside of any routine
+typedef struct {
+    uint16_t bank; // Of the entry point
+    uint16_t address;
+    uint32_t parent;
+    uint32_t first_child;
+    uint32_t next_sibling;
+    uint32_t calls;
+    uint64_t cycles; // Spent in the routine itself, not in the routines it called
+}
+ProfileNode;
+
+typedef struct {
+    uint32_t node;
+    uint16_t sp; // Value of SP once the routine has returned
+}
+ProfileFrame;
+
+typedef struct {
+    bool is_enabled;
+    uint64_t cycles;
+    uint64_t halted_cycles;
+
+    // T-cycles per executed address, allocated when first enabled
+    uint64_t *rom_cycles; // ROM bank * ROM_BANK_SIZE + offset in the bank
+    uint64_t *ram_cycles; // Address - PROFILE_RAM_START, the RAM banks aren't told apart
+
+    // Call tree, a routine called from different places has a node for each
+    ProfileNode *nodes;
+    uint32_t node_count;
+    ProfileFrame *frames;
+    uint32_t frame_count;
+
+    // Instruction being executed
+    uint64_t *instr_cycles;
+    uint16_t instr_sp;
+    uint8_t instr_opcode;
+}
+Profiler;
+
+// Position of the PPU when the event happened
+typedef struct {
+    uint8_t type; // TimelineEventType
+    uint8_t line; // LY
+    uint16_t dot; // T-cycles since the start of the line
+    uint16_t address; // Register written, interrupt vector, DMA source
+    uint16_t data; // Value written, mode entered, interrupt number, DMA length
+    uint16_t pc; // Of the next instruction
+}
+TimelineEvent;
+
+typedef struct {
+    bool is_enabled;
+
+    // Double buffered, allocated when first enabled
+    TimelineEvent *events; // Frame being recorded
+    uint32_t count;
+    uint32_t dropped;
+
+    TimelineEvent *frame; // Last complete frame, ends when V-Blank starts
+    uint32_t frame_count;
+    uint32_t frame_dropped;
+}
+Timeline;
+
+// Short loop the program is spinning in, only the last taken backward branch is watched
+typedef struct {
+    bool is_enabled;
+
+    uint16_t start; // Target of the backward branch
+    uint16_t end; // Address following the branch
+    bool is_pure; // Only register operations and reads of memory the program alone or the timer and PPU change
+
+    Registers registers; // At the start of the iteration
+    uint16_t ticks; // T-cycles since the start of the iteration
+    int32_t quiet_ticks; // T-cycles from the start of the iteration before the timer or PPU change anything
+}
+IdleLoop;
+
+// Instruction decoded the first time it runs, kept until a write to its bytes
+typedef struct {
+    void *execute; // NULL when not decoded
+    uint16_t operand;
+    uint8_t length;
+    uint8_t operand_length;
+    uint8_t ticks; // T-cycles of the prefix and operand fetches
+}
+DecodedInstr;
+
+// One entry per address of the memory code runs from, the other regions are decoded every time
+typedef struct {
+    bool is_enabled; // Entries are kept up to date either way, only the lookup is skipped
+
+    DecodedInstr **rom_banks; // Per cartridge ROM bank, allocated on first use
+    DecodedInstr **wram_banks; // 8x4KB WRAM Banks
+    DecodedInstr *hram;
+    DecodedInstr uncached; // Last instruction decoded outside of them
+}
+InstrCache;
+
+// Run of instructions translated to host code, entered at its first address
+typedef struct {
+    int32_t (*code)(GameBoy *, uint32_t); // NULL until translated, returns the address of the last instruction run (-1 if none)
+    uint8_t size; // Bytes of SM83 code covered
+    uint8_t runs; // Times the address was interpreted instead, JIT_NEVER if it can't start a block
+}
+JitBlock;
+
+// Blocks keyed by the bank and address of their first instruction, the same regions as the instruction cache
+typedef struct {
+    bool is_enabled;
+    bool is_invalidated; // A write dropped a block, the running block stops after the instruction
+
+    uint8_t *code; // Executable memory the blocks are emitted to, flushed once full
+    uint32_t code_used;
+
+    JitBlock **rom_banks; // Per cartridge ROM bank, allocated on first use
+    JitBlock **wram_banks;
+    JitBlock *hram;
+
+    // Blocks covering each byte of the RAM code runs from, a write to a covered byte drops them
+    uint8_t **wram_coverage;
+    uint8_t *hram_coverage;
+}
+Jit;
+
 struct GameBoy_s {
-    bool is_running;
+    SDL_atomic_t is_running; // Cleared by the main thread to stop the emulation thread
 
     CPU cpu;
     PPU ppu;
@@ -263,6 +523,12 @@ struct GameBoy_s {
     APU apu;
     Cart cart;
     Input input;
+    Trace trace;
+    Profiler profiler;
+    Timeline timeline;
+    IdleLoop idle;
+    InstrCache icache;
+    Jit jit;
 };
 
 void init(GameBoy *gb);
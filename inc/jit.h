@@ -0,0 +1,102 @@
+#pragma once
+
+// Blocks are only translated for x86-64 hosts, the others keep interpreting
+#if defined(__x86_64__) || defined(_M_X64)
+#define JIT_HOST_X64
+#endif
+
+// Times an address is interpreted before the block starting there is translated
+#define JIT_HOT_RUNS 8
+#define JIT_NEVER UINT8_MAX
+
+// Bytes of SM83 code in a block, a write looks this far back for the blocks covering it
+#define JIT_BLOCK_MAX_SIZE 64
+
+// Executable memory, flushed when less than a whole block is left
+#define JIT_CODE_SIZE (8 * 1024 * 1024)
+#define JIT_BLOCK_CODE_MAX (32 * 1024)
+#define JIT_MAX_EXITS 512
+
+// Host registers (x86-64 encoding)
+#define HOST_EAX 0
+#define HOST_ECX 1
+#define HOST_EDX 2
+#define HOST_EBX 3
+#define HOST_EBP 5
+#define HOST_ESI 6
+#define HOST_EDI 7
+#define HOST_R8D 8
+#define HOST_R9D 9
+
+// Condition codes of the host jumps
+#define HOST_CC_B 0x2
+#define HOST_CC_AE 0x3
+#define HOST_CC_E 0x4
+#define HOST_CC_NE 0x5
+
+
+// Memory an instruction accesses, known before it runs so the block can leave first
+typedef enum {
+    AccessNone,
+    AccessBC,
+    AccessDE,
+    AccessHL,
+    AccessHighC, // IO_START + C
+    AccessHigh, // IO_START + operand
+    AccessAbsolute, // Operand
+    AccessAbsolutePair, // Operand and the byte after
+    AccessPop, // SP and SP + 1
+    AccessPush // SP - 1 and SP - 2
+}
+AccessSource;
+
+typedef struct {
+    AccessSource source;
+    bool is_write;
+}
+MemoryAccess;
+
+// ALU operations in the order of their opcodes (bits 3-5)
+typedef enum {
+    AluAdd, AluAdc, AluSub, AluSbc, AluAnd, AluXor, AluOr, AluCp
+}
+AluOperation;
+
+typedef enum {
+    NotEmitted, Emitted, EmittedEnd
+}
+EmitResult;
+
+// Jump out of the block, the exits are emitted after the instructions
+typedef struct {
+    uint32_t patch; // Offset of the jump's rel32
+    uint16_t pc;
+    bool is_pc_set; // The instruction already set the PC
+    int32_t last; // Address of the last instruction run, -1 if none
+}
+BlockExit;
+
+typedef struct {
+    uint8_t *code;
+    uint32_t size;
+    bool is_write_pending; // The last instruction wrote memory, it may have dropped the block
+
+    BlockExit exits[JIT_MAX_EXITS];
+    uint16_t exit_count;
+}
+Emitter;
+
+// Blocks of the bank mapped at an address
+typedef struct {
+    JitBlock *blocks;
+    uint8_t *coverage; // NULL for the ROM, which isn't written
+    uint16_t offset; // Of the address in the bank
+    uint16_t size; // Of the bank
+}
+CodeRegion;
+
+
+void init_jit(GameBoy *);
+bool start_jit(GameBoy *);
+bool execute_block(GameBoy *);
+void invalidate_blocks(GameBoy *, uint16_t);
@@ -10,5 +10,11 @@ typedef struct {
     bool should_show_help;
     bool is_headless;
     bool should_print_info;
+    bool should_correct_colours;
+    int sample_rate;
+    const char *trace_path;
+    bool should_skip_idle_loops;
+    bool should_cache_instrs;
+    bool should_use_jit;
 }
 CliArgs;
@@ -49,6 +49,11 @@
 #define WRAM_BANK_COUNT 8
 #define VRAM_BANK_COUNT 2
 
+// Tile data at the start of each VRAM bank, the tile maps follow
+#define VRAM_TILE_SIZE 16
+#define VRAM_TILE_COUNT 384
+#define VRAM_TILE_DATA_END 0x97FF
+
 // VRAM DMA (CGB)
 #define HDMA1 0xFF51
 #define HDMA2 0xFF52
@@ -58,8 +63,31 @@
 #define HDMA5_LENGTH 0x7F
 #define HDMA5_MODE 0x80
 
+// Work RAM bank (CGB)
+#define SVBK 0xFF70
+#define SVBK_BANK 0x7
+
 // Serial output
 #define SB 0xFF01
+#define SC 0xFF02
+
+// Watchpoint flags
+#define WATCH_READ 0x1
+#define WATCH_WRITE 0x2
+
+// Write tracking
+#define WRITE_PAGE_SIZE 256
+#define WRITE_PAGE_COUNT 256
+
+// Side effects of an IO register, the registers without any are plain memory
+typedef struct {
+    uint8_t (*read)(const GameBoy *); // Value kept outside of the IO memory
+    bool (*write)(GameBoy *, uint16_t, uint8_t *); // Program writes, false if the value isn't stored
+    bool is_always_written; // The handler also sees the writes of the emulator itself
+    uint8_t read_mask; // Unused bits, read as 1 by the program
+    bool is_colour_only; // CGB register, absent on a DMG cart
+}
+IORegister;
 
 
 void init_mmu(GameBoy *);
@@ -75,3 +103,11 @@ void write_register(GameBoy *, uint16_t, uint8_t, uint8_t);
 uint8_t read_register(GameBoy *, uint16_t, uint8_t);
 
 void update_hdma(GameBoy *);
+void set_watch_handler(GameBoy *, void (*)(void *, uint16_t, uint8_t, bool), void *);
+uint16_t mapped_bank(const GameBoy *, uint16_t);
+
+void start_write_tracking(GameBoy *);
+void stop_write_tracking(GameBoy *);
+void clear_changed_bytes(GameBoy *);
+void clear_write_counts(GameBoy *);
+bool is_byte_changed(const GameBoy *, uint16_t);
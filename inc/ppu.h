@@ -4,8 +4,12 @@
 #define SCREEN_HEIGHT 144
 #define FRAMERATE 60.0
 #define CLOCKS_PER_SCANLINE 456 
+#define PIXEL_TRANSFER_START 80 // Scan clock at which each mode starts on a visible line
+#define HBLANK_START 253
 
 #define SCREEN_INITIAL_SCALE 4
+#define FRAMEBUFFER_COUNT 3
+#define FRAME_READY 0x80
 #define WINDOW_TITLE "jgbc"
 
 // LCDC: LCD Control Register 
@@ -115,10 +119,13 @@ void init_ppu(GameBoy *);
 void reset_ppu(GameBoy *);
 void init_window(GameBoy *);
 
-void render(GameBoy *);
+bool render(GameBoy *);
 void update_ppu(GameBoy *);
+uint16_t next_ppu_event(GameBoy *);
+const uint32_t *take_frame(GameBoy *);
 
 void get_sprites(GameBoy *);
 
+void set_colour_correction(GameBoy *, bool);
 void palette_index_write(GameBoy *, uint16_t, uint8_t);
 void palette_data_write(GameBoy *, uint16_t, uint8_t);
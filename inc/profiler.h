@@ -0,0 +1,19 @@
+#pragma once
+
+// Code from VRAM onwards is counted by address only
+#define PROFILE_RAM_START 0x8000
+#define PROFILE_RAM_SIZE 0x8000
+
+#define PROFILE_MAX_NODES 65536
+#define PROFILE_MAX_DEPTH 256
+
+
+void init_profiler(GameBoy *);
+void start_profiler(GameBoy *);
+void stop_profiler(GameBoy *);
+void clear_profiler(GameBoy *);
+
+void begin_profile(GameBoy *);
+void end_profile(GameBoy *);
+void profile_halted(GameBoy *);
+void profile_interrupt(GameBoy *, uint16_t);
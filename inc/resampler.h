@@ -0,0 +1,15 @@
+#pragma once
+
+// Filter length in input samples, a multiple of 8 for the vector kernels
+#define RESAMPLER_TAPS 64
+
+// Fractional positions tabulated between two input samples
+#define RESAMPLER_PHASES 64
+
+// Passband edge as a fraction of the output rate (just under Nyquist)
+#define RESAMPLER_CUTOFF 0.42f
+
+
+void init_resampler(Resampler *);
+void set_resampler_rates(Resampler *, float, float);
+bool resample(Resampler *, float, float, float *);
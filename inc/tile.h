@@ -0,0 +1,7 @@
+#pragma once
+
+#define TILE_WIDTH 8
+
+
+void set_tile_decoder(GameBoy *);
+uint8_t reverse_tile_byte(uint8_t);
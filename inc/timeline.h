@@ -0,0 +1,17 @@
+#pragma once
+
+// Events past this in a frame are only counted, a frame with the LCD off never ends
+#define TIMELINE_MAX_EVENTS 16384
+
+typedef enum {
+    EventModeChange, EventInterrupt, EventTimerOverflow, EventDMA, EventHDMA, EventRegisterWrite
+}
+TimelineEventType;
+
+
+void init_timeline(GameBoy *);
+void start_timeline(GameBoy *);
+void stop_timeline(GameBoy *);
+
+void log_event(GameBoy *, TimelineEventType, uint16_t, uint16_t);
+void end_timeline_frame(GameBoy *);
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdio.h>
+
+// The trace is kept in a ring of chunks, the oldest chunk is dropped when the ring is full
+#define TRACE_CHUNK_SIZE 65536
+#define TRACE_CHUNK_COUNT 64
+
+// Largest encoded record, a chunk is closed when less than this is left
+#define TRACE_MAX_RECORD_SIZE 32
+
+// Each record starts with a mask of the fields stored after it, the others are the same as in the previous record
+// The memory bytes and the T-cycles since the previous record are always stored
+#define TRACE_PC 0x1 // Not the address following the previous instruction
+#define TRACE_BANK 0x2
+#define TRACE_AF 0x4
+#define TRACE_BC 0x8
+#define TRACE_DE 0x10
+#define TRACE_HL 0x20
+#define TRACE_SP 0x40
+#define TRACE_ALL 0x7F
+
+// Gameboy Doctor log line (state before each instruction)
+#define TRACE_DOCTOR_LINE_SIZE 80
+
+
+void init_trace(GameBoy *);
+bool start_trace(GameBoy *, const char *);
+void stop_trace(GameBoy *);
+void record_instr(GameBoy *);
+
+uint32_t trace_chunk_count(const GameBoy *);
+const TraceChunk *trace_chunk(const GameBoy *, uint32_t);
+uint32_t decode_trace_chunk(const TraceChunk *, TraceRecord *);
+
+bool read_trace_chunk(FILE *, TraceChunk *);
+void format_doctor_line(const TraceRecord *, char *);
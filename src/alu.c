@@ -46,10 +46,7 @@ uint8_t and(GameBoy *gb, const uint8_t a, const uint8_t b) {
     
     const uint8_t result = a & b;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 1);
-    FSET(FLAG_CARRY, 0);
+    REG(F) = FLAGS(result == 0, 0, 1, 0);
 
     return result;
 }
@@ -58,10 +55,7 @@ uint8_t or(GameBoy *gb, const uint8_t a, const uint8_t b) {
 
     const uint8_t result = a | b;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    FSET(FLAG_CARRY, 0);
+    REG(F) = FLAGS(result == 0, 0, 0, 0);
 
     return result;
 }
@@ -70,10 +64,7 @@ uint8_t xor(GameBoy *gb, const uint8_t a, const uint8_t b) {
     
     const uint8_t result = a ^ b;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    FSET(FLAG_CARRY, 0);
+    REG(F) = FLAGS(result == 0, 0, 0, 0);
 
     return result;
 }
@@ -82,9 +73,7 @@ uint8_t inc(GameBoy *gb, const uint8_t operand) {
 
     const uint8_t result = operand + 1;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, did_byte_half_carry(operand, 1));
+    REG(F) = FLAGS(result == 0, 0, did_byte_half_carry(operand, 1), FGET(FLAG_CARRY));
 
     return result;
 }
@@ -93,9 +82,7 @@ uint8_t dec(GameBoy *gb, const uint8_t operand) {
 
     const uint8_t result = operand - 1;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 1);
-    FSET(FLAG_HALFCARRY, did_byte_half_borrow(operand, 1));
+    REG(F) = FLAGS(result == 0, 1, did_byte_half_borrow(operand, 1), FGET(FLAG_CARRY));
 
     return result;
 }
@@ -104,10 +91,7 @@ uint8_t add_byte(GameBoy *gb, const uint8_t a, const uint8_t b) {
     
     const uint8_t result = a + b;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, did_byte_half_carry(a, b));
-    FSET(FLAG_CARRY, did_byte_full_carry(a, b));
+    REG(F) = FLAGS(result == 0, 0, did_byte_half_carry(a, b), did_byte_full_carry(a, b));
     
     return result;
 }
@@ -117,10 +101,10 @@ uint8_t add_byte_carry(GameBoy *gb, const uint8_t a, const uint8_t b) {
     const uint8_t carry = FGET(FLAG_CARRY);
     const uint8_t result = a + b + carry;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, did_byte_half_carry(a, carry) || did_byte_half_carry(a + carry, b));
-    FSET(FLAG_CARRY, did_byte_full_carry(a, carry) || did_byte_full_carry(a + carry, b));
+    const bool half_carry = did_byte_half_carry(a, carry) || did_byte_half_carry(a + carry, b);
+    const bool full_carry = did_byte_full_carry(a, carry) || did_byte_full_carry(a + carry, b);
+
+    REG(F) = FLAGS(result == 0, 0, half_carry, full_carry);
 
     return result;
 }
@@ -129,10 +113,7 @@ uint8_t sub_byte(GameBoy *gb, const uint8_t a, const uint8_t b) {
 
     const uint8_t result = a - b;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 1);
-    FSET(FLAG_HALFCARRY, did_byte_half_borrow(a, b));
-    FSET(FLAG_CARRY, did_byte_full_borrow(a, b));
+    REG(F) = FLAGS(result == 0, 1, did_byte_half_borrow(a, b), did_byte_full_borrow(a, b));
 
     return result;
 }
@@ -142,10 +123,10 @@ uint8_t sub_byte_carry(GameBoy *gb, const uint8_t a, const uint8_t b) {
     const uint8_t carry = FGET(FLAG_CARRY);
     const uint8_t result = a - b - carry;
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 1);
-    FSET(FLAG_HALFCARRY, did_byte_half_borrow(a, carry) || did_byte_half_borrow(a - carry, b));
-    FSET(FLAG_CARRY, did_byte_full_borrow(a, carry) || did_byte_full_borrow(a - carry, b));
+    const bool half_borrow = did_byte_half_borrow(a, carry) || did_byte_half_borrow(a - carry, b);
+    const bool full_borrow = did_byte_full_borrow(a, carry) || did_byte_full_borrow(a - carry, b);
+
+    REG(F) = FLAGS(result == 0, 1, half_borrow, full_borrow);
 
     return result;
 }
@@ -154,9 +135,7 @@ uint16_t add_short(GameBoy *gb, const uint16_t a, const uint16_t b) {
     
     const uint16_t result = a + b;
 
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, did_short_half_carry(a, b));
-    FSET(FLAG_CARRY, did_short_full_carry(a, b));
+    REG(F) = FLAGS(FGET(FLAG_ZERO), 0, did_short_half_carry(a, b), did_short_full_carry(a, b));
 
     return result;
 }
@@ -164,10 +143,7 @@ uint16_t add_short(GameBoy *gb, const uint16_t a, const uint16_t b) {
 // Designed to add a signed value to the SP register (only used in 2 instructions)
 uint16_t add_sp_signed_byte(GameBoy *gb, const uint16_t sp, const int8_t operand) {
 
-    FSET(FLAG_ZERO, 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, did_byte_half_carry(sp & 0xFF, (uint8_t) operand));
-    FSET(FLAG_CARRY, did_byte_full_carry(sp & 0xFF, (uint8_t) operand));
+    REG(F) = FLAGS(0, 0, did_byte_half_carry(sp & 0xFF, (uint8_t) operand), did_byte_full_carry(sp & 0xFF, (uint8_t) operand));
 
     return sp + operand;
 }
@@ -177,12 +153,9 @@ uint8_t rotate_left(GameBoy *gb, const uint8_t operand, const bool affect_zero)
     
     // Shift the carry flag onto the result
     const uint8_t result = (operand << 1) | FGET(FLAG_CARRY);
-    FSET(FLAG_ZERO, (result == 0) && affect_zero);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    
+
     // Set the carry flag to the old bit 7
-    FSET(FLAG_CARRY, (operand & 0x80) >> 7);
+    REG(F) = FLAGS((result == 0) && affect_zero, 0, 0, operand >> 7);
 
     return result;
 }
@@ -193,12 +166,8 @@ uint8_t rotate_right(GameBoy *gb, const uint8_t operand) {
     // Shift the carry flag onto the result
     const uint8_t result = (operand >> 1) | (FGET(FLAG_CARRY) << 7);
 
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    
     // Set the carry flag to the old bit 0
-    FSET(FLAG_CARRY, operand & 0x01);
+    REG(F) = FLAGS(result == 0, 0, 0, operand & 0x01);
 
     return result;
 }
@@ -208,12 +177,9 @@ uint8_t rotate_left_carry(GameBoy *gb, const uint8_t operand, const bool affect_
 
     // Shift bit 0 onto the top 
     const uint8_t result = ((operand << 1) | (operand >> 7));
-    FSET(FLAG_ZERO, (result == 0) && affect_zero);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    
+
     // Set the carry flag to the old bit 7
-    FSET(FLAG_CARRY, (operand & 0x80) >> 7);
+    REG(F) = FLAGS((result == 0) && affect_zero, 0, 0, operand >> 7);
 
     return result;
 }
@@ -223,12 +189,9 @@ uint8_t rotate_right_carry(GameBoy *gb, const uint8_t operand, const bool affect
 
     // Shift bit 0 onto the top 
     const uint8_t result = ((operand >> 1) | (operand << 7));
-    FSET(FLAG_ZERO, (result == 0) && affect_zero);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    
+
     // Set the carry flag to the old bit 0
-    FSET(FLAG_CARRY, operand & 0x01);
+    REG(F) = FLAGS((result == 0) && affect_zero, 0, 0, operand & 0x01);
 
     return result;
 }
@@ -236,15 +199,11 @@ uint8_t rotate_right_carry(GameBoy *gb, const uint8_t operand, const bool affect
 // Shift 0 on the bottom and pop the top into the carry flag
 uint8_t shift_left_arith(GameBoy *gb, const uint8_t operand) {
 
-    // Set the carry flag to the old bit 7
-    FSET(FLAG_CARRY, (operand & 0x80) >> 7);
-
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-
     // Shift left (set bit 0 to 0)
     const uint8_t result = operand << 1;
-    FSET(FLAG_ZERO, result == 0);
+
+    // Set the carry flag to the old bit 7
+    REG(F) = FLAGS(result == 0, 0, 0, operand >> 7);
 
     return result;
 }
@@ -252,15 +211,11 @@ uint8_t shift_left_arith(GameBoy *gb, const uint8_t operand) {
 // Shift the top bit onto the top and pop the bottom into the carry flag
 uint8_t shift_right_arith(GameBoy *gb, const uint8_t operand) {
 
-    // Set the carry flag to the old bit 0
-    FSET(FLAG_CARRY, operand & 1);
-
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-
     // Shift right
     const uint8_t result = (operand & 0x80) | (operand >> 1);
-    FSET(FLAG_ZERO, result == 0);
+
+    // Set the carry flag to the old bit 0
+    REG(F) = FLAGS(result == 0, 0, 0, operand & 0x01);
 
     return result;
 }
@@ -268,15 +223,11 @@ uint8_t shift_right_arith(GameBoy *gb, const uint8_t operand) {
 // Shift 0 onto the top and pop the bottom into the carry flag
 uint8_t shift_right_logic(GameBoy *gb, const uint8_t operand) {
     
-    // Set the carry flag to the old bit 0
-    FSET(FLAG_CARRY, operand & 0x01);
-
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-
     // Shift right
     const uint8_t result = operand >> 1;
-    FSET(FLAG_ZERO, result == 0);
+
+    // Set the carry flag to the old bit 0
+    REG(F) = FLAGS(result == 0, 0, 0, operand & 0x01);
 
     return result;
 }
@@ -286,10 +237,7 @@ uint8_t swap(GameBoy *gb, const uint8_t operand) {
 
     const uint8_t result = ((operand & 0xF0) >> 4) | ((operand & 0x0F) << 4);
     
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    FSET(FLAG_CARRY, 0);
+    REG(F) = FLAGS(result == 0, 0, 0, 0);
     
     return result;
 }
@@ -298,9 +246,7 @@ void test_bit(GameBoy *gb, const uint8_t regis, const uint8_t bit) {
 
     const uint8_t bit_val = GET_BIT(regis, bit);
 
-    FSET(FLAG_ZERO, bit_val == 0);
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 1);
+    REG(F) = FLAGS(bit_val == 0, 0, 1, FGET(FLAG_CARRY));
 }
 
 uint8_t reset_bit(const uint8_t regis, const uint8_t bit) {
@@ -339,12 +285,11 @@ uint8_t daa(GameBoy *gb, const uint8_t regis) {
             result -= 0x60;
     }
 
-    if(result & 0x100)
-        FSET(FLAG_CARRY, 1);
+    // The carry is only ever set
+    const bool carry = FGET(FLAG_CARRY) || (result & 0x100);
 
     result &= 0xFF;
-    FSET(FLAG_ZERO, result == 0);
-    FSET(FLAG_HALFCARRY, 0);
+    REG(F) = FLAGS(result == 0, FGET(FLAG_SUBTRACT), 0, carry);
 
     return (uint8_t) result;
 }
@@ -6,46 +6,94 @@
 #include "mmu.h"
 #include "cpu.h"
 #include "apu.h"
+#include "resampler.h"
+
+static void open_audio_device(GameBoy *, int);
+static void audio_callback(void *, uint8_t *, int);
+static void clock_frame_sequencer(GameBoy *);
+static void mix_sample(APU *);
+static uint32_t buffered_samples(APU *);
+static void push_sample(APU *, float, float);
+static void update_rate_control(APU *);
 
 static void update_envelope(ChannelEnvelope *);
 static void update_length(ChannelLength *, bool *);
 
 static void reset_square_wave(GameBoy *gb, uint8_t idx);
 static void read_square(GameBoy *, uint16_t, uint8_t, uint8_t);
-static void update_square(GameBoy *, uint8_t);
+static void update_square(GameBoy *, uint8_t, int);
 static void update_square_sweep(GameBoy *);
 static void trigger_square(GameBoy *, uint8_t);
 
 static void reset_wave(GameBoy *gb);
 static void read_wave(GameBoy *, uint16_t, uint8_t);
-static void update_wave(GameBoy *);
+static void update_wave(GameBoy *, int);
 static void trigger_wave(GameBoy *);
 
 static void reset_noise(GameBoy *gb);
 static void read_noise(GameBoy *, uint16_t, uint8_t);
-static void update_noise(GameBoy *);
+static void update_noise(GameBoy *, int);
 static void trigger_noise(GameBoy *);
 
 
 void init_apu(GameBoy *gb) {
 
+    gb->apu.device_id = 0;
+    gb->apu.buffer.data = calloc(AUDIO_BUFFER_SIZE, sizeof(float));
+    SDL_AtomicSet(&gb->apu.buffer.read_position, 0);
+    SDL_AtomicSet(&gb->apu.buffer.write_position, 0);
+
+    init_resampler(&gb->apu.resampler);
+    open_audio_device(gb, SAMPLE_RATE);
+}
+
+// Reopens the (paused) audio device at another output rate
+bool set_sample_rate(GameBoy *gb, const int rate) {
+
+    if(rate <= 0 || rate > MAX_SAMPLE_RATE)
+        return false;
+
+    open_audio_device(gb, rate);
+    return true;
+}
+
+static void open_audio_device(GameBoy *gb, const int rate) {
+
+    APU *apu = &gb->apu;
+
+    if(apu->device_id != 0)
+        SDL_CloseAudioDevice(apu->device_id);
+
     SDL_AudioSpec desired_spec;
     SDL_zero(desired_spec);
     
-    desired_spec.freq = SAMPLE_RATE;
+    desired_spec.freq = rate;
     desired_spec.format = AUDIO_F32SYS;
     desired_spec.channels = AUDIO_CHANNELS;
     desired_spec.samples = AUDIO_SAMPLES;
+    desired_spec.callback = audio_callback;
+    desired_spec.userdata = apu;
 
-    gb->apu.device_id = SDL_OpenAudioDevice(
+    apu->device_id = SDL_OpenAudioDevice(
         NULL, 
         0, 
         &desired_spec, 
-        &gb->apu.audio_spec, 
+        &apu->audio_spec, 
         SDL_AUDIO_ALLOW_FREQUENCY_CHANGE
     );
 
-    gb->apu.buffer = malloc(gb->apu.audio_spec.size);
+    // The resampler can't reach a faster device, SDL converts from the requested rate instead
+    if(apu->device_id != 0 && apu->audio_spec.freq > MAX_SAMPLE_RATE) {
+        SDL_CloseAudioDevice(apu->device_id);
+        apu->device_id = SDL_OpenAudioDevice(NULL, 0, &desired_spec, &apu->audio_spec, 0);
+    }
+
+    // Keep producing (silent) samples at the requested rate without an audio device
+    if(apu->device_id == 0)
+        apu->audio_spec = desired_spec;
+
+    set_resampler_rates(&apu->resampler, (float) CLOCK_SPEED / MIX_DIVIDER, apu->audio_spec.freq);
+    update_rate_control(apu);
 }
 
 void reset_apu(GameBoy *gb) {
@@ -63,13 +111,16 @@ void reset_apu(GameBoy *gb) {
     gb->apu.enabled = true;
     gb->apu.frame_sequencer.clock = 0;
     gb->apu.frame_sequencer.step = 0;
-    gb->apu.downsample_clock = 0;
+    gb->apu.mix.clock = 0;
+
+    for(int i = 0; i < 4; ++i)
+        gb->apu.mix.channels[i] = 0;
+
+    gb->apu.resampler.clock = 0.0f;
+    update_rate_control(&gb->apu);
 
     gb->apu.left_volume = 0;
     gb->apu.right_volume = 0;
-
-    gb->apu.buffer_position = 0;
-    memset(gb->apu.buffer, 0, gb->apu.audio_spec.size);
 }
 
 static void reset_square_wave(GameBoy *gb, const uint8_t idx) {
@@ -137,75 +188,166 @@ void update_apu(GameBoy *gb) {
     if(!apu->enabled)
         return;
 
-    for(int i = 0; i < gb->cpu.ticks; ++i) { 
-
-        if(apu->frame_sequencer.clock >= FRAME_SEQUENCER_DIVIDER) {
-
-            apu->frame_sequencer.clock = 0;
-            apu->frame_sequencer.step++;
-            apu->frame_sequencer.step %= 9;
-
-            switch(gb->apu.frame_sequencer.step) {
-                case 2:
-                case 6:
-                    update_square_sweep(gb);
-                    // fallthrough
-                case 0:
-                case 4:
-                    update_length(&apu->square_waves[0].length, &apu->square_waves[0].enabled);
-                    update_length(&apu->square_waves[1].length, &apu->square_waves[1].enabled);
-                    update_length(&apu->wave.length, &apu->wave.enabled);
-                    update_length(&apu->noise.length, &apu->noise.enabled);
-                    break;
-
-                case 7: // every 8 clocks
-                    update_envelope(&apu->square_waves[0].envelope);
-                    update_envelope(&apu->square_waves[1].envelope);
-                    update_envelope(&apu->noise.envelope);
-                    break;
-            }
-        }
-        else
-            apu->frame_sequencer.clock++;
+    // Advance in spans that end on a frame sequencer step or a mix sample
+    // The channels only change state on their own clock events within a span
+    int ticks = gb->cpu.ticks;
 
-        update_square(gb, 0);
-        update_square(gb, 1);
-        update_wave(gb);
-        update_noise(gb);
+    while(ticks > 0) {
 
-        if(apu->downsample_clock++ >= DOWNSAMPLE_DIVIDER) {
-            apu->downsample_clock = 0;
+        const bool is_sequencer_tick = apu->frame_sequencer.clock >= FRAME_SEQUENCER_DIVIDER;
+        int span = 1;
 
-            float left = 0.0f;
-            float right = 0.0f;
+        if(is_sequencer_tick)
+            clock_frame_sequencer(gb);
+        else {
+            span = FRAME_SEQUENCER_DIVIDER - apu->frame_sequencer.clock;
 
-            for(int j = 0; j < 4; ++j) {
+            if(span > ticks)
+                span = ticks;
 
-                if(apu->left_enabled[j])
-                    left += apu->channels[j];
+            if(span > MIX_DIVIDER - apu->mix.clock)
+                span = MIX_DIVIDER - apu->mix.clock;
 
-                if(apu->right_enabled[j])
-                    right += apu->channels[j];
-            }
+            apu->frame_sequencer.clock += span;
+        }
 
-            left *= (float) gb->apu.left_volume / 7.f;
-            right *= (float) gb->apu.right_volume / 7.f;
+        update_square(gb, 0, span);
+        update_square(gb, 1, span);
+        update_wave(gb, span);
+        update_noise(gb, span);
 
-            apu->buffer[apu->buffer_position] = left / 60.0f;
-            apu->buffer[apu->buffer_position + 1] = right / 60.0f;
+        apu->mix.clock += span;
+        ticks -= span;
 
-            apu->buffer_position += AUDIO_CHANNELS;
+        if(apu->mix.clock == MIX_DIVIDER) {
+            apu->mix.clock = 0;
+            mix_sample(apu);
         }
     }
+}
+
+static void clock_frame_sequencer(GameBoy *gb) {
+
+    APU *apu = &gb->apu;
 
-    const size_t max_samples = apu->audio_spec.size / sizeof(float);
+    apu->frame_sequencer.clock = 0;
+    apu->frame_sequencer.step++;
+    apu->frame_sequencer.step %= 9;
+
+    switch(apu->frame_sequencer.step) {
+        case 2:
+        case 6:
+            update_square_sweep(gb);
+            // fallthrough
+        case 0:
+        case 4:
+            update_length(&apu->square_waves[0].length, &apu->square_waves[0].enabled);
+            update_length(&apu->square_waves[1].length, &apu->square_waves[1].enabled);
+            update_length(&apu->wave.length, &apu->wave.enabled);
+            update_length(&apu->noise.length, &apu->noise.enabled);
+            break;
 
-    if(apu->buffer_position >= max_samples) {
-        SDL_QueueAudio(apu->device_id, apu->buffer, apu->audio_spec.size);
-        apu->buffer_position = 0;
+        case 7: // every 8 clocks
+            update_envelope(&apu->square_waves[0].envelope);
+            update_envelope(&apu->square_waves[1].envelope);
+            update_envelope(&apu->noise.envelope);
+            break;
     }
 }
 
+// Mixes the averaged channels and hands the result to the resampler
+static void mix_sample(APU *apu) {
+
+    float left = 0.0f;
+    float right = 0.0f;
+
+    for(int i = 0; i < 4; ++i) {
+
+        if(apu->left_enabled[i])
+            left += apu->mix.channels[i];
+
+        if(apu->right_enabled[i])
+            right += apu->mix.channels[i];
+
+        apu->mix.channels[i] = 0;
+    }
+
+    left *= (float) apu->left_volume / (7.f * MIX_DIVIDER);
+    right *= (float) apu->right_volume / (7.f * MIX_DIVIDER);
+
+    float out[AUDIO_CHANNELS];
+
+    if(resample(&apu->resampler, left / 60.0f, right / 60.0f, out))
+        push_sample(apu, out[0], out[1]);
+}
+
+// True when the audio callback is running low and the emulator should produce another frame
+// Nothing drains the buffer without an audio device, the caller has to pace itself
+bool is_audio_starved(GameBoy *gb) {
+    return gb->apu.device_id == 0 || buffered_samples(&gb->apu) < AUDIO_BUFFER_SIZE / 2;
+}
+
+// Runs on the audio thread, drains the buffer and pads with silence on underrun
+static void audio_callback(void *data, uint8_t *stream, const int length) {
+
+    APU *apu = data;
+    float *out = (float *) stream;
+    const uint32_t count = length / sizeof(float);
+
+    const uint32_t read = SDL_AtomicGet(&apu->buffer.read_position);
+    const uint32_t write = SDL_AtomicGet(&apu->buffer.write_position);
+    SDL_MemoryBarrierAcquire();
+
+    const uint32_t available = (write - read) < count ? (write - read) : count;
+    uint32_t i = 0;
+
+    for(; i < available; ++i)
+        out[i] = apu->buffer.data[(read + i) & (AUDIO_BUFFER_SIZE - 1)];
+
+    for(; i < count; ++i)
+        out[i] = 0.0f;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&apu->buffer.read_position, read + available);
+}
+
+static uint32_t buffered_samples(APU *apu) {
+    const uint32_t read = SDL_AtomicGet(&apu->buffer.read_position);
+    const uint32_t write = SDL_AtomicGet(&apu->buffer.write_position);
+
+    return write - read;
+}
+
+// Appends a stereo sample, dropped if the buffer is full
+static void push_sample(APU *apu, const float left, const float right) {
+
+    const uint32_t read = SDL_AtomicGet(&apu->buffer.read_position);
+    const uint32_t write = SDL_AtomicGet(&apu->buffer.write_position);
+    SDL_MemoryBarrierAcquire();
+
+    if(write - read > AUDIO_BUFFER_SIZE - AUDIO_CHANNELS)
+        return;
+
+    apu->buffer.data[(write + 0) & (AUDIO_BUFFER_SIZE - 1)] = left;
+    apu->buffer.data[(write + 1) & (AUDIO_BUFFER_SIZE - 1)] = right;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&apu->buffer.write_position, write + AUDIO_CHANNELS);
+
+    if((write / AUDIO_CHANNELS) % AUDIO_RATE_CONTROL_INTERVAL == 0)
+        update_rate_control(apu);
+}
+
+// Dynamic rate control: the emulator and the audio device run off different clocks
+// Slightly raise the output rate when the buffer drains and lower it when it fills
+static void update_rate_control(APU *apu) {
+
+    const float fill = (float) buffered_samples(apu) / AUDIO_BUFFER_SIZE;
+    const float rate = apu->audio_spec.freq * (1.0f + (1.0f - 2.0f * fill) * AUDIO_MAX_RATE_DELTA);
+
+    apu->resampler.step = apu->resampler.input_rate / rate;
+}
+
 void audio_register_write(GameBoy *gb, const uint16_t address, const uint8_t value) {
 
     switch(address) {
@@ -339,7 +481,7 @@ static void read_square(GameBoy *gb, const uint16_t address, const uint8_t value
     }
 }
 
-static void update_square(GameBoy *gb, const uint8_t idx) {
+static void update_square(GameBoy *gb, const uint8_t idx, int ticks) {
 
     assert(idx <= 1);
     SquareWave *square = &gb->apu.square_waves[idx];
@@ -351,20 +493,32 @@ static void update_square(GameBoy *gb, const uint8_t idx) {
         { 0, 1, 1, 1, 1, 1, 1, 0 }  // 75%
     };
 
-    if(square->clock-- <= 0)
-    {
-        square->clock = (2048 - square->frequency) * 4;
-        square->duty.step++;
-        square->duty.step &= 0x7;
-    }
+    while(ticks > 0) {
 
-    if(square->enabled && square->dac_enabled && 
-       duty_table[square->duty.mode][square->duty.step]) {
+        int span = 1;
 
-        gb->apu.channels[idx] = square->envelope.current_volume;
+        if(square->clock <= 0)
+        {
+            square->clock = (2048 - square->frequency) * 4;
+            square->duty.step++;
+            square->duty.step &= 0x7;
+        }
+        else {
+            span = square->clock < ticks ? square->clock : ticks;
+            square->clock -= span;
+        }
+
+        if(square->enabled && square->dac_enabled && 
+           duty_table[square->duty.mode][square->duty.step]) {
+
+            gb->apu.channels[idx] = square->envelope.current_volume;
+        }
+        else
+            gb->apu.channels[idx] = 0;
+
+        gb->apu.mix.channels[idx] += gb->apu.channels[idx] * span;
+        ticks -= span;
     }
-    else
-        gb->apu.channels[idx] = 0;
 }
 
 static void update_square_sweep(GameBoy *gb) {
@@ -439,35 +593,49 @@ static void read_wave(GameBoy *gb, const uint16_t address, const uint8_t value)
     }
 }
 
-static void update_wave(GameBoy *gb) {
+static void update_wave(GameBoy *gb, int ticks) {
 
     Wave *wave = &gb->apu.wave;
 
-    if(wave->clock-- <= 0)
-    {
-        wave->clock = (2048 - wave->frequency) * 2;
+    while(ticks > 0) {
 
-        if(wave->position++ == 31)
-            wave->position = 0;
-    }
+        uint32_t span = 1;
+
+        if(wave->clock == 0)
+        {
+            wave->clock = (2048 - wave->frequency) * 2;
+
+            if(wave->position++ == 31)
+                wave->position = 0;
+        }
+        else {
+            span = wave->clock < (uint32_t) ticks ? wave->clock : (uint32_t) ticks;
+            wave->clock -= span;
+        }
+
+        if(wave->enabled && wave->volume_code > 0) {
 
-    if(wave->enabled && wave->volume_code > 0) {
+            // Two 4 bit samples per byte of the 16 byte table
+            const uint8_t byte = SREAD8(WAVE_TABLE_START + wave->position / 2);
+            uint8_t sample;
 
-        uint8_t sample;
+            // Top 4 bits
+            if(wave->position % 2 == 0)
+                sample = (byte & 0xF0) >> 4;
 
-        // Top 4 bits
-        if(wave->position % 2 == 0)
-            sample = (SREAD8(WAVE_TABLE_START + wave->position) & 0xF0) >> 4;
+            // Lower 4 bits
+            else
+                sample = byte & 0xF;
 
-        // Lower 4 bits
+            sample = sample >> (wave->volume_code - 1);
+            gb->apu.channels[CHANNEL_WAVE] = sample;
+        }
         else
-            sample = SREAD8(WAVE_TABLE_START + wave->position - 1) & 0xF;
+            gb->apu.channels[CHANNEL_WAVE] = 0;
 
-        sample = sample >> (wave->volume_code - 1);
-        gb->apu.channels[CHANNEL_WAVE] = sample;
+        gb->apu.mix.channels[CHANNEL_WAVE] += gb->apu.channels[CHANNEL_WAVE] * span;
+        ticks -= span;
     }
-    else
-        gb->apu.channels[CHANNEL_WAVE] = 0;
 }
 
 static void trigger_wave(GameBoy *gb) {
@@ -513,46 +681,60 @@ static void read_noise(GameBoy *gb, const uint16_t address, const uint8_t value)
     }
 }
 
-static void update_noise(GameBoy *gb) {
+static void update_noise(GameBoy *gb, int ticks) {
 
     Noise *noise = &gb->apu.noise;
 
     // TODO: figure out why this channel is so loud
 
-    if(!noise->enabled)
+    // A disabled channel holds its last output
+    if(!noise->enabled) {
+        gb->apu.mix.channels[CHANNEL_NOISE] += gb->apu.channels[CHANNEL_NOISE] * ticks;
         return;
+    }
 
-    if(noise->clock-- <= 0)
-    {
-        uint8_t divisor = 0;
-
-        switch(noise->divisor_code) {
-            case 0: divisor = 8; break;
-            case 1: divisor = 16; break;
-            case 2: divisor = 32; break;
-            case 3: divisor = 48; break;
-            case 4: divisor = 64; break;
-            case 5: divisor = 80; break;
-            case 6: divisor = 96; break;
-            case 7: divisor = 112; break;
-        }
+    while(ticks > 0) {
 
-        noise->clock = (divisor << noise->clock_shift);
+        uint32_t span = 1;
+
+        if(noise->clock == 0)
+        {
+            uint8_t divisor = 0;
+
+            switch(noise->divisor_code) {
+                case 0: divisor = 8; break;
+                case 1: divisor = 16; break;
+                case 2: divisor = 32; break;
+                case 3: divisor = 48; break;
+                case 4: divisor = 64; break;
+                case 5: divisor = 80; break;
+                case 6: divisor = 96; break;
+                case 7: divisor = 112; break;
+            }
 
-        const uint8_t new_bit = (GET_BIT(noise->lfsr, 1) ^ GET_BIT(noise->lfsr, 0));
+            noise->clock = (divisor << noise->clock_shift);
 
-        noise->lfsr >>= 1;
-        noise->lfsr |= (new_bit << 14);
+            const uint8_t new_bit = (GET_BIT(noise->lfsr, 1) ^ GET_BIT(noise->lfsr, 0));
 
-        if(noise->width_mode == 1) {
-            noise->lfsr &= ~(1 << 5);
-            noise->lfsr |= (new_bit << 5);
+            noise->lfsr >>= 1;
+            noise->lfsr |= (new_bit << 14);
+
+            if(noise->width_mode == 1) {
+                noise->lfsr &= ~(1 << 5);
+                noise->lfsr |= (new_bit << 5);
+            }
+
+            noise->last_result = !GET_BIT(noise->lfsr, 0);
+        }
+        else {
+            span = noise->clock < (uint32_t) ticks ? noise->clock : (uint32_t) ticks;
+            noise->clock -= span;
         }
 
-        noise->last_result = !GET_BIT(noise->lfsr, 0);
+        gb->apu.channels[CHANNEL_NOISE] = noise->last_result * noise->envelope.current_volume;
+        gb->apu.mix.channels[CHANNEL_NOISE] += gb->apu.channels[CHANNEL_NOISE] * span;
+        ticks -= span;
     }
-
-    gb->apu.channels[CHANNEL_NOISE] = noise->last_result * noise->envelope.current_volume;
 }
 
 static void trigger_noise(GameBoy *gb) {
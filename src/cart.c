@@ -218,6 +218,7 @@ static void copy_data(GameBoy *gb, FILE *file) {
 static void set_banks(GameBoy *gb) {
     gb->mmu.ram_bank = -1;
     gb->mmu.rom_bank = 1;
+    gb->mmu.rom00_bank = 0;
 
     gb->mmu.rom00 = gb->cart.rom_banks[0];
     gb->mmu.romNN = gb->cart.rom_banks[1];
@@ -3,9 +3,22 @@
 #include "macro.h"
 #include "mmu.h"
 #include "cpu.h"
+#include "ppu.h"
 #include "instr.h"
+#include "trace.h"
+#include "profiler.h"
+#include "timeline.h"
+#include "icache.h"
+#include "idle.h"
+#include "jit.h"
 
 static void service_interrupt(GameBoy *, uint8_t);
+static uint32_t next_timer_event(GameBoy *);
+static void increment_timer(GameBoy *, uint32_t);
+static bool timer_signal(const GameBoy *);
+
+// Bit of the divider that clocks TIMA for each input clock in TAC (4096, 262144, 65536 and 16384 Hz)
+static const uint8_t timer_bits[4] = { 9, 3, 5, 7 };
 
 
 void reset_cpu(GameBoy *gb) {
@@ -19,8 +32,12 @@ void reset_cpu(GameBoy *gb) {
 
     gb->cpu.is_halted = false;
     gb->cpu.is_double_speed = false;
-    gb->cpu.div_clock = 0;
-    gb->cpu.cnt_clock = 0;
+    gb->cpu.is_ime_scheduled = false;
+    gb->cpu.is_halt_bug = false;
+    gb->cpu.divider = 0;
+    gb->cpu.timer_bit = timer_bits[0];
+    gb->cpu.is_timer_running = false;
+    gb->cpu.pending_interrupts = 0;
 }
 
 /*
@@ -37,66 +54,79 @@ Instruction find_instr(GameBoy *gb, const uint16_t address) {
         return instructions[opcode];
 }
 
+// Same as find_instr for bytes that were read beforehand (at least two)
+Instruction decode_instr(const uint8_t *bytes) {
+    return bytes[0] == 0xCB ? cb_instructions[bytes[1]] : instructions[bytes[0]];
+}
+
 void execute_instr(GameBoy *gb) {
 
+    if(gb->trace.is_recording)
+        record_instr(gb);
+
     gb->cpu.ticks = CPU_STEP;
 
-    if(gb->cpu.is_halted)
+    if(gb->cpu.is_halted) {
+        gb->cpu.ticks = next_event(gb);
+
+        if(gb->profiler.is_enabled)
+            profile_halted(gb);
+
         return;
+    }
 
-    const Instruction instruction = find_instr(gb, REG(PC));
+    // A translated block runs as many instructions as fit before the next event
+    if(gb->jit.is_enabled && execute_block(gb))
+        return;
 
-    void (*opcode_function)() = instruction.execute;
+    if(gb->profiler.is_enabled)
+        begin_profile(gb);
 
-    uint8_t operand_len = instruction.length - 1;
-    uint16_t operand;
+    const uint16_t instr_start = REG(PC);
+    const bool is_ime_scheduled = gb->cpu.is_ime_scheduled;
+    const DecodedInstr *instruction;
 
-    if(instruction.extended) {
-        operand_len--;
-        TICK(1);
+    if(gb->cpu.is_halt_bug) {
+        gb->cpu.is_halt_bug = false;
+        instruction = decode_repeated(gb, instr_start);
     }
+    else
+        instruction = fetch_instr(gb, instr_start);
 
-    const uint16_t instr_start = REG(PC);
-    REG(PC) += instruction.length;
+    void (*opcode_function)() = instruction->execute;
 
-    switch(operand_len) {
+    gb->cpu.ticks += instruction->ticks;
+    REG(PC) += instruction->length;
+
+    switch(instruction->operand_length) {
 
         case 0:
             opcode_function(gb);
             break;
 
         case 1:
-            TICK(1);
-            operand = SREAD8(instr_start + 1);
-            opcode_function(gb, (uint8_t) operand);
+            opcode_function(gb, (uint8_t) instruction->operand);
             break;
 
         case 2:
-            TICK(2);
-            operand = SREAD16(instr_start + 1);
-            opcode_function(gb, operand);
+            opcode_function(gb, instruction->operand);
             break;
 
         default:
             ASSERT_NOT_REACHED();
     }
-}
 
-/*
-    F Register Flags
-*/
+    // Unless the instruction following EI was DI
+    if(is_ime_scheduled && gb->cpu.is_ime_scheduled) {
+        gb->cpu.is_ime_scheduled = false;
+        REG(IME) = true;
+    }
 
-void set_flag(GameBoy *gb, const uint8_t flag, const uint8_t value) {
-    assert(value <= 1);
+    if(gb->profiler.is_enabled)
+        end_profile(gb);
 
-    if(value == 0)
-        REG(F) &= ~(1 << flag);
-    else
-        REG(F) |= 1 << flag;
-}
-
-uint8_t get_flag(GameBoy *gb, const uint8_t flag) {
-    return GET_BIT(REG(F), flag);
+    if(gb->idle.is_enabled)
+        update_idle_loop(gb, instr_start);
 }
 
 /*
@@ -144,12 +174,14 @@ uint16_t stack_peek_short(GameBoy *gb) {
 
 void check_interrupts(GameBoy *gb) {
 
-    const uint8_t enable = SREAD8(IE);
-    const uint8_t request = SREAD8(IF);
+    const uint8_t pending = gb->cpu.pending_interrupts;
+
+    if(pending == 0)
+        return;
 
     for(int i = 0; i < 5; i++) {
         
-        if(GET_BIT(enable, i) && GET_BIT(request, i)) {
+        if(GET_BIT(pending, i)) {
 
             if(REG(IME))
                 service_interrupt(gb, i);
@@ -170,61 +202,130 @@ static void service_interrupt(GameBoy *gb, const uint8_t number) {
     };
 
     assert(number < 5);
+    const uint16_t sp = REG(SP);
     PUSH16(REG(PC));
     
     WREG(IF, number, 0);
     REG(IME) = false;
     REG(PC) = interrupt[number];
+
+    // The interrupt runs first, the repeated opcode is read again from the return address
+    gb->cpu.is_halt_bug = false;
+
+    if(gb->profiler.is_enabled)
+        profile_interrupt(gb, sp);
+
+    if(gb->timeline.is_enabled)
+        log_event(gb, EventInterrupt, interrupt[number], number);
+}
+
+// T-cycles until the next step that can request an interrupt or change the PPU mode
+// Steps up to this long only move the timer, PPU and APU clocks forward, so they can be merged
+// Nothing happens while halted until then, the halted steps are merged into one
+// DIV still changes in between, a running program can see it (next_divider_event)
+uint16_t next_event(GameBoy *gb) {
+
+    // Double speed steps the timer twice per PPU update and HDMA copies a block per step
+    if(gb->cpu.is_double_speed || gb->mmu.hdma.is_active)
+        return CPU_STEP;
+
+    // The pending interrupt is serviced or ends the halt after this step
+    if((REG(IME) || gb->cpu.is_halted) && gb->cpu.pending_interrupts)
+        return CPU_STEP;
+
+    const uint32_t timer_ticks = next_timer_event(gb);
+    const uint32_t ppu_ticks = next_ppu_event(gb);
+    const uint32_t ticks = timer_ticks < ppu_ticks ? timer_ticks : ppu_ticks;
+
+    // The LCD is off and the timer stopped or slow
+    return ticks < MAX_STEP ? ticks : MAX_STEP;
+}
+
+// T-cycles until DIV next changes
+uint16_t next_divider_event(const GameBoy *gb) {
+    return 256 - (gb->cpu.divider & 0xFF);
 }
 
 /*
     Timer
 */
 
+// T-cycles until TIMA overflows, the timer doesn't request anything while it's stopped
+static uint32_t next_timer_event(GameBoy *gb) {
+
+    if(!gb->cpu.is_timer_running)
+        return UINT32_MAX;
+
+    // The falling edges of the bit are a period apart
+    const uint16_t divider = gb->cpu.divider;
+    const uint16_t period = 1 << (gb->cpu.timer_bit + 1);
+
+    return (period - (divider & (period - 1))) + (uint32_t) (0xFF - SREAD8(TIMA)) * period;
+}
+
+// DIV and TIMA both follow the divider, which moves on by the length of each step
+// TIMA counts the falling edges of one of its bits, only found when the step crosses one
 void update_timer(GameBoy *gb) {
 
-    gb->cpu.div_clock += gb->cpu.ticks;
+    const uint16_t divider = gb->cpu.divider;
+    gb->cpu.divider += gb->cpu.ticks;
 
-    // The divider register updates at one 256th of the clock speed (aka 256 clocks)
-    // Reset the clock and update the register
-    if(gb->cpu.div_clock >= 256) {
-        const uint8_t curr_div = SREAD8(DIV);
-        SWRITE8(DIV, curr_div + 1);
+    if(!gb->cpu.is_timer_running)
+        return;
 
-        gb->cpu.div_clock = 0;
-    }
+    const uint8_t shift = gb->cpu.timer_bit + 1;
+    const uint32_t edges = ((divider + gb->cpu.ticks) >> shift) - (divider >> shift);
 
-    // The timer counter updates at the rate given in the control register
-    // Although unlike the divider, it must be enabled in the control register
-    // (0 == Stopped) (1 == Running)
-    if(RREG(TAC, TAC_STOP) == 1) {
+    if(edges > 0)
+        increment_timer(gb, edges);
+}
 
-        gb->cpu.cnt_clock += gb->cpu.ticks;
-        const uint8_t speed_index = SREAD8(TAC) & 0x3;
+// Writing DIV clears the whole divider, which is a falling edge if the timer bit was set
+void reset_divider(GameBoy *gb) {
 
-        static const uint16_t timer_thresholds[4] = {
-            CLOCK_SPEED / 4096,
-            CLOCK_SPEED / 262144,
-            CLOCK_SPEED / 65536,
-            CLOCK_SPEED / 16384
-        };
+    const bool signal = timer_signal(gb);
+    gb->cpu.divider = 0;
 
-        const uint16_t threshold = timer_thresholds[speed_index];
+    if(signal)
+        increment_timer(gb, 1);
+}
 
-        while(gb->cpu.cnt_clock >= threshold) {
+// Called before TAC is written, stopping the timer or switching to a bit that is clear can be a falling edge
+void set_timer_control(GameBoy *gb, const uint8_t value) {
 
-            const uint8_t curr_cnt = SREAD8(TIMA);
-            uint8_t new_cnt;
+    const bool signal = timer_signal(gb);
 
-            if(curr_cnt + 1 == 256) {
-                new_cnt = SREAD8(TMA);
-                WREG(IF, IEF_TIMER, 1);
-            }
-            else
-                new_cnt = curr_cnt + 1;
+    gb->cpu.timer_bit = timer_bits[value & 0x3];
+    gb->cpu.is_timer_running = GET_BIT(value, TAC_STOP);
 
-            SWRITE8(TIMA, new_cnt);
-            gb->cpu.cnt_clock -= threshold;
-        }
+    if(signal && !timer_signal(gb))
+        increment_timer(gb, 1);
+}
+
+uint8_t read_divider(const GameBoy *gb) {
+    return gb->cpu.divider >> 8;
+}
+
+static void increment_timer(GameBoy *gb, const uint32_t count) {
+
+    uint32_t counter = SREAD8(TIMA) + count;
+
+    // Reloaded from TMA, the increments left carry on from there
+    while(counter > 0xFF) {
+
+        const uint8_t modulo = SREAD8(TMA);
+        counter = modulo + (counter - 0x100);
+
+        WREG(IF, IEF_TIMER, 1);
+
+        if(gb->timeline.is_enabled)
+            log_event(gb, EventTimerOverflow, TIMA, modulo);
     }
+
+    SWRITE8(TIMA, counter);
+}
+
+// Input of the falling edge detector that increments TIMA
+static bool timer_signal(const GameBoy *gb) {
+    return gb->cpu.is_timer_running && GET_BIT(gb->cpu.divider, gb->cpu.timer_bit);
 }
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <cstring>
+#include "debugger/core.h"
+
+// Overload set for visiting the commands
+template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
+template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
+
+
+Core::Core(std::shared_ptr<Emulator::GameBoy> gb) : _gb(std::move(gb)) {
+
+    _thread = nullptr;
+    _is_running = false;
+
+    _back_state = 1;
+    _front_state = 0;
+    _ready_state = 2;
+
+    _is_paused = true;
+    _stop_count = 0;
+
+    _next_stop_fall_thru = std::nullopt;
+    _next_stop_jump = std::nullopt;
+    _breakpoint_flags.fill(0);
+    _is_watchpoint_hit = false;
+    _change_reset = ChangeReset::OnResume;
+
+    _speed = Speed::Normal;
+    _frame_duration = static_cast<uint64_t>(SDL_GetPerformanceFrequency() / FRAMERATE);
+    _next_frame = 0;
+}
+
+void Core::start() {
+
+    Emulator::set_watch_handler(_gb.get(), &Core::watch_handler, this);
+
+    // The UI has a state to show before the core publishes anything
+    _states[_front_state].capture(*_gb);
+
+    _is_running = true;
+    _thread = SDL_CreateThread(&Core::emulate, "emulation", this);
+}
+
+void Core::stop() {
+
+    _is_running = false;
+
+    if(_thread != nullptr)
+        SDL_WaitThread(_thread, nullptr);
+
+    _thread = nullptr;
+}
+
+bool Core::is_running() const {
+    return _is_running;
+}
+
+// Called by the UI thread, only waits if the core has fallen a whole queue behind
+void Core::push(Command &&command) {
+    while(!_commands.push(std::move(command)))
+        SDL_Delay(1);
+}
+
+// Called by the UI thread, swaps in the last published state if there is a new one
+Core::State &Core::take_state() {
+
+    if(_ready_state.load(std::memory_order_acquire) & STATE_READY)
+        _front_state = _ready_state.exchange(_front_state, std::memory_order_acq_rel) & ~STATE_READY;
+
+    return _states[_front_state];
+}
+
+int Core::emulate(void *data) {
+
+    auto *core = static_cast<Core *>(data);
+
+    while(core->_is_running) {
+
+        const auto has_changed = core->apply_commands();
+
+        if(core->_is_paused) {
+
+            // Edits made while paused are shown straight away
+            if(has_changed)
+                core->publish();
+
+            SDL_Delay(1);
+            continue;
+        }
+
+        if(core->_speed == Speed::Normal && !core->is_frame_due()) {
+            SDL_Delay(1);
+            continue;
+        }
+
+        core->run_frame();
+        core->publish();
+    }
+
+    return 0;
+}
+
+// The audio buffer paces the emulation, the performance counter does without an audio device
+bool Core::is_frame_due() {
+
+    if(_gb->apu.device_id != 0)
+        return Emulator::is_audio_starved(_gb.get());
+
+    const auto now = SDL_GetPerformanceCounter();
+
+    if(now < _next_frame)
+        return false;
+
+    // Too far behind to catch up
+    if(now - _next_frame > _frame_duration * FRAMERATE)
+        _next_frame = now;
+
+    _next_frame += _frame_duration;
+    return true;
+}
+
+void Core::run_frame() {
+
+    static const uint32_t max_ticks = CLOCK_SPEED / FRAMERATE;
+
+    auto *const gb = _gb.get();
+    uint32_t frame_ticks = 0;
+
+    while(!_is_paused && frame_ticks < max_ticks) {
+
+        Emulator::execute_instr(gb);
+        Emulator::update_ppu(gb);
+
+        if(gb->cpu.is_double_speed) {
+            Emulator::execute_instr(gb);
+            Emulator::update_ppu(gb);
+        }
+
+        Emulator::update_timer(gb);
+        Emulator::update_apu(gb);
+        Emulator::check_interrupts(gb);
+
+        frame_ticks += gb->cpu.ticks;
+
+        if(!_breakpoints.empty() && is_breakpoint(REG(PC)))
+            stop_at_pc();
+
+        if(_is_watchpoint_hit) {
+            _is_watchpoint_hit = false;
+            stop_at_pc();
+        }
+
+        if(_next_stop_fall_thru == REG(PC) || _next_stop_jump == REG(PC)) {
+            _next_stop_fall_thru = std::nullopt;
+            _next_stop_jump = std::nullopt;
+            stop_at_pc();
+        }
+    }
+}
+
+// The UI scrolls to the PC when it sees the stop count change
+void Core::stop_at_pc() {
+    set_paused(true);
+    _stop_count++;
+}
+
+bool Core::apply_commands() {
+
+    bool has_changed = false;
+
+    while(auto command = _commands.pop()) {
+        apply(*command);
+        has_changed = true;
+    }
+
+    return has_changed;
+}
+
+void Core::apply(Command &command) {
+
+    auto *const gb = _gb.get();
+
+    std::visit(overloaded {
+        [&](const SetPaused &c) { set_paused(c.value); },
+        [&](const SetNextStop &c) {
+            _next_stop_fall_thru = c.fall_thru;
+            _next_stop_jump = c.jump;
+        },
+        [&](const Reset &) { Emulator::reset(gb); },
+        [&](const AddBreakpoint &c) {
+            if(std::find(_breakpoints.begin(), _breakpoints.end(), c.breakpoint) != _breakpoints.end())
+                return;
+
+            _breakpoints.push_back(c.breakpoint);
+            update_breakpoint_flags(c.breakpoint.address);
+        },
+        [&](const RemoveBreakpoint &c) {
+            const auto it = std::find(_breakpoints.begin(), _breakpoints.end(), c.breakpoint);
+
+            if(it == _breakpoints.end())
+                return;
+
+            _breakpoints.erase(it);
+            update_breakpoint_flags(c.breakpoint.address);
+        },
+        [&](const AddWatchpoint &c) {
+            if(std::find(_watchpoints.begin(), _watchpoints.end(), c.watchpoint) != _watchpoints.end())
+                return;
+
+            _watchpoints.push_back(c.watchpoint);
+            update_watch_flags();
+        },
+        [&](const RemoveWatchpoint &c) {
+            const auto it = std::find(_watchpoints.begin(), _watchpoints.end(), c.watchpoint);
+
+            if(it == _watchpoints.end())
+                return;
+
+            _watchpoints.erase(it);
+            update_watch_flags();
+        },
+        [&](const WriteMemory &c) {
+            // Patch the mapped ROM bank directly instead of going through the MBC
+            if(!c.is_program && c.address <= ROMNN_END) {
+                auto *const bank = c.address <= ROM00_END ? gb->mmu.rom00 : gb->mmu.romNN;
+                bank[c.address & (ROM_BANK_SIZE - 1)] = c.value;
+                Emulator::invalidate_instr(gb, c.address);
+                Emulator::invalidate_blocks(gb, c.address);
+            }
+            else
+                Emulator::write_byte(gb, c.address, c.value, c.is_program);
+        },
+        [&](const SetChangeReset &c) { _change_reset = c.value; },
+        [&](const SetSpeed &c) {
+            _speed = c.value;
+            _next_frame = SDL_GetPerformanceCounter();
+        },
+        [&](const Edit &edit) { edit(gb); }
+    }, command);
+}
+
+// Called by the core thread, the snapshot is copied in the back buffer before it is swapped in
+void Core::publish() {
+
+    auto &state = _states[_back_state];
+
+    state.capture(*_gb);
+    state.is_paused = _is_paused;
+    state.stop_count = _stop_count;
+    state.last_watchpoint_hit = _last_watchpoint_hit;
+
+    if(_change_reset == ChangeReset::EveryFrame)
+        Emulator::clear_changed_bytes(_gb.get());
+
+    _back_state = _ready_state.exchange(_back_state | STATE_READY, std::memory_order_acq_rel) & ~STATE_READY;
+}
+
+void Core::set_paused(const bool value) {
+
+    if(_is_paused && !value && _change_reset == ChangeReset::OnResume)
+        Emulator::clear_changed_bytes(_gb.get());
+
+    _is_paused = value;
+    _next_frame = SDL_GetPerformanceCounter();
+    SDL_PauseAudioDevice(_gb->apu.device_id, value);
+}
+
+// Checks the address as currently mapped, a banked breakpoint only hits in its own bank
+bool Core::is_breakpoint(const uint16_t addr) const {
+
+    const auto flags = _breakpoint_flags[addr];
+
+    if(flags & BREAKPOINT_ANY_BANK)
+        return true;
+
+    if(flags & BREAKPOINT_BANKED)
+        return _banked_breakpoints.count(static_cast<uint32_t>(_gb->mmu.rom_bank) << 16 | addr) > 0;
+
+    return false;
+}
+
+// Rebuilds the lookup for one address from the list, only done when breakpoints change
+void Core::update_breakpoint_flags(const uint16_t addr) {
+
+    _breakpoint_flags[addr] = 0;
+
+    for(auto it = _banked_breakpoints.begin(); it != _banked_breakpoints.end();)
+        it = (*it & 0xFFFF) == addr ? _banked_breakpoints.erase(it) : std::next(it);
+
+    for(const auto &breakpoint : _breakpoints) {
+
+        if(breakpoint.address != addr)
+            continue;
+
+        if(breakpoint.bank.has_value()) {
+            _breakpoint_flags[addr] |= BREAKPOINT_BANKED;
+            _banked_breakpoints.insert(static_cast<uint32_t>(*breakpoint.bank) << 16 | addr);
+        }
+        else
+            _breakpoint_flags[addr] |= BREAKPOINT_ANY_BANK;
+    }
+}
+
+// Flags every watched address for the emulator, the watchpoints are disarmed when there are none
+void Core::update_watch_flags() {
+
+    auto *flags = _gb->mmu.watch.flags;
+    std::fill(flags, flags + UINT16_MAX + 1, 0);
+
+    for(const auto &watchpoint : _watchpoints) {
+
+        const uint8_t mask = (watchpoint.on_read ? WATCH_READ : 0) | (watchpoint.on_write ? WATCH_WRITE : 0);
+
+        for(uint32_t addr = watchpoint.start; addr <= watchpoint.end; ++addr)
+            flags[addr] |= mask;
+    }
+
+    _gb->mmu.watch.is_armed = !_watchpoints.empty();
+}
+
+// Called by the emulator in the middle of an instruction, the core stops once it completes
+void Core::watch_handler(void *data, const uint16_t addr, const uint8_t value, const bool is_write) {
+
+    auto *core = static_cast<Core *>(data);
+    const auto bank = Emulator::mapped_bank(core->_gb.get(), addr);
+
+    for(const auto &watchpoint : core->_watchpoints) {
+
+        if(addr < watchpoint.start || addr > watchpoint.end)
+            continue;
+
+        if(is_write ? !watchpoint.on_write : !watchpoint.on_read)
+            continue;
+
+        if(watchpoint.bank.has_value() && *watchpoint.bank != bank)
+            continue;
+
+        if(watchpoint.value.has_value() && *watchpoint.value != value)
+            continue;
+
+        core->_last_watchpoint_hit = WatchpointHit { addr, bank, value, is_write };
+        core->_is_watchpoint_hit = true;
+        return;
+    }
+}
+
+bool Core::Breakpoint::operator==(const Breakpoint &other) const {
+    return address == other.address && bank == other.bank;
+}
+
+bool Core::Watchpoint::operator==(const Watchpoint &other) const {
+    return start == other.start && end == other.end && bank == other.bank &&
+           on_read == other.on_read && on_write == other.on_write && value == other.value;
+}
+
+void Core::State::capture(const Emulator::GameBoy &gb) {
+
+    _gb = gb;
+    auto &mmu = _gb.mmu;
+
+    for(size_t i = 0; i < VRAM_BANK_COUNT; ++i) {
+        std::memcpy(_vram[i].data(), gb.mmu.vram_banks[i], VRAM_BANK_SIZE);
+        _vram_banks[i] = _vram[i].data();
+
+        if(gb.mmu.vram == gb.mmu.vram_banks[i])
+            mmu.vram = _vram_banks[i];
+    }
+
+    for(size_t i = 0; i < WRAM_BANK_COUNT; ++i) {
+        std::memcpy(_wram[i].data(), gb.mmu.wram_banks[i], WRAM_BANK_SIZE);
+        _wram_banks[i] = _wram[i].data();
+
+        if(gb.mmu.wram00 == gb.mmu.wram_banks[i])
+            mmu.wram00 = _wram_banks[i];
+
+        if(gb.mmu.wramNN == gb.mmu.wram_banks[i])
+            mmu.wramNN = _wram_banks[i];
+    }
+
+    mmu.vram_banks = _vram_banks.data();
+    mmu.wram_banks = _wram_banks.data();
+
+    // The ROM never changes, the banks are shared
+    if(gb.mmu.extram != nullptr) {
+        std::memcpy(_extram.data(), gb.mmu.extram, EXTRAM_BANK_SIZE);
+        mmu.extram = _extram.data();
+    }
+
+    std::memcpy(_oam.data(), gb.mmu.oam, OAM_SIZE);
+    std::memcpy(_io.data(), gb.mmu.io, IO_SIZE);
+    _io[DIV - IO_START] = Emulator::read_divider(&gb);
+    std::memcpy(_hram.data(), gb.mmu.hram, HRAM_SIZE);
+    _ier = *gb.mmu.ier;
+
+    mmu.oam = _oam.data();
+    mmu.io = _io.data();
+    mmu.hram = _hram.data();
+    mmu.ier = &_ier;
+
+    // The pages point to the live bank pointers, a write to the snapshot has to land in its copies
+    for(auto &page : mmu.pages) {
+        if(page.region == &gb.mmu.vram)
+            page.region = &mmu.vram;
+        else if(page.region == &gb.mmu.extram)
+            page.region = &mmu.extram;
+        else if(page.region == &gb.mmu.wram00)
+            page.region = &mmu.wram00;
+        else if(page.region == &gb.mmu.wramNN)
+            page.region = &mmu.wramNN;
+        else if(page.region == &gb.mmu.oam)
+            page.region = &mmu.oam;
+    }
+
+    // The decoded instructions and translated blocks belong to the core, the snapshot decodes every time
+    _gb.icache.is_enabled = false;
+    _gb.icache.rom_banks = nullptr;
+    _gb.icache.wram_banks = nullptr;
+    _gb.icache.hram = nullptr;
+    _gb.jit = {};
+
+    // Only the last complete frame of the timeline is kept, the core records into the other buffer
+    if(gb.timeline.frame != nullptr) {
+        _timeline.assign(gb.timeline.frame, gb.timeline.frame + gb.timeline.frame_count);
+        _gb.timeline.frame = _timeline.data();
+    }
+
+    _gb.timeline.events = nullptr;
+
+    if(gb.mmu.writes.changed != nullptr) {
+        std::memcpy(_changed.data(), gb.mmu.writes.changed, _changed.size());
+        mmu.writes.changed = _changed.data();
+    }
+
+    // Reading the snapshot never calls back into the debugger, nor switches the live cartridge banks
+    mmu.watch.is_armed = false;
+    mmu.serial_write_handler = nullptr;
+    mmu.mbc_handler = nullptr;
+}
+
+Emulator::GameBoy *Core::State::gb() {
+    return &_gb;
+}
@@ -16,22 +16,25 @@
 #include "debugger/windows/io.h"
 #include "debugger/windows/memory.h"
 #include "debugger/windows/palettes.h"
+#include "debugger/windows/profiler.h"
 #include "debugger/windows/registers.h"
 #include "debugger/windows/serial.h"
+#include "debugger/windows/sprites.h"
 #include "debugger/windows/stack.h"
+#include "debugger/windows/tilemap.h"
+#include "debugger/windows/tiles.h"
+#include "debugger/windows/timeline.h"
+#include "debugger/windows/trace.h"
 
 
-Debugger::Debugger(const char *rom_path) {
+Debugger::Debugger(const char *rom_path) : _gb(std::make_shared<Emulator::GameBoy>()), _core(_gb) {
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
 
-    _is_paused = true;
     _window = nullptr;
     _gl_context = nullptr;
+    _state = nullptr;
+    _stop_count = 0;
 
-    _next_stop_fall_thru = std::nullopt;
-    _next_stop_jump = std::nullopt;
-
-    _gb = std::make_shared<Emulator::GameBoy>();
     Emulator::init(_gb.get());
 
     if(!Emulator::load_rom(_gb.get(), rom_path)) {
@@ -58,8 +61,14 @@ Debugger::Debugger(const char *rom_path) {
     _windows.emplace(WindowId::IO, std::make_shared<Windows::IO>(*this));
     _windows.emplace(WindowId::Memory, std::make_shared<Windows::Memory>(*this));
     _windows.emplace(WindowId::Palettes, std::make_shared<Windows::Palettes>(*this));
+    _windows.emplace(WindowId::Profiler, std::make_shared<Windows::Profiler>(*this));
     _windows.emplace(WindowId::Registers, std::make_shared<Windows::Registers>(*this));
+    _windows.emplace(WindowId::Sprites, std::make_shared<Windows::Sprites>(*this));
     _windows.emplace(WindowId::Stack, std::make_shared<Windows::Stack>(*this));
+    _windows.emplace(WindowId::Tilemap, std::make_shared<Windows::Tilemap>(*this));
+    _windows.emplace(WindowId::Tiles, std::make_shared<Windows::Tiles>(*this));
+    _windows.emplace(WindowId::Timeline, std::make_shared<Windows::Timeline>(*this));
+    _windows.emplace(WindowId::Trace, std::make_shared<Windows::Trace>(*this));
 
     auto serial_window = std::make_shared<Windows::Serial>(*this);
     _gb->mmu.serial_write_handler = serial_window->serial_write_handler;
@@ -110,18 +119,45 @@ std::shared_ptr<Window> &Debugger::window(const Debugger::WindowId id) {
     return _windows.at(id);
 }
 
+Core::State &Debugger::state() const {
+    return *_state;
+}
+
 bool Debugger::is_paused() const {
-    return _is_paused;
+    return _state->is_paused;
 }
 
 void Debugger::set_paused(const bool value) {
-    _is_paused = value;
-    SDL_PauseAudioDevice(_gb->apu.device_id, value);
+    _core.push(Core::SetPaused { value });
 }
 
 void Debugger::set_next_stop(const std::optional<uint16_t> fall_thru_addr, const std::optional<uint16_t> jump_addr) {
-    _next_stop_fall_thru = fall_thru_addr;
-    _next_stop_jump = jump_addr;
+    _core.push(Core::SetNextStop { fall_thru_addr, jump_addr });
+}
+
+void Debugger::set_change_reset(const ChangeReset value) {
+    _core.push(Core::SetChangeReset { value });
+}
+
+void Debugger::set_speed(const Speed value) {
+    _core.push(Core::SetSpeed { value });
+}
+
+// System writes by default, program writes have the side effects of the CPU writing the address
+void Debugger::write_memory(const uint16_t addr, const uint8_t value, const bool is_program) {
+    _core.push(Core::WriteMemory { addr, value, is_program });
+}
+
+void Debugger::edit(Core::Edit &&edit) {
+    _core.push(std::move(edit));
+}
+
+void Debugger::reset() {
+    _core.push(Core::Reset {});
+}
+
+void Debugger::quit() {
+    _core.stop();
 }
 
 void Debugger::init_imgui() const {
@@ -162,29 +198,15 @@ void Debugger::load_symbols(const char *rom_path) {
 
     symbols_path.append(".sym");
 
-    std::ifstream file(symbols_path);
-
-    if(!file.is_open())
-        return;
-
-    auto disassembly_window = std::dynamic_pointer_cast<Windows::Disassembly>(_windows.at(WindowId::Disassembly));
-
-    std::string line;
-    while(std::getline(file, line)) {
-
-        if(line.empty() || line[0] == ';')
-            continue;
-
-        // TODO: deal with banks
-        uint8_t bank;
-        uint16_t addr;
-        char label_buffer[101];
+    _symbols.load(symbols_path);
+}
 
-        sscanf(line.c_str(), "%hhd:%4hX %100s", &bank, &addr, label_buffer);
+const Symbols &Debugger::symbols() const {
+    return _symbols;
+}
 
-        std::string label(label_buffer);
-        disassembly_window->add_label(addr, label);
-    }
+TileCache &Debugger::tiles() {
+    return _tiles;
 }
 
 Debugger::~Debugger() {
@@ -197,83 +219,65 @@ Debugger::~Debugger() {
     SDL_Quit();
 }
 
+// The emulator runs on the core thread, this thread only renders the snapshots it publishes
 void Debugger::run() {
 
     SDL_Event event;
-    _gb->is_running = true;
-
-    static auto window_disassembly = std::dynamic_pointer_cast<Windows::Disassembly>(_windows.at(WindowId::Disassembly));
-    static auto *gb = _gb.get();
-
-    while(_gb->is_running) {
-
-        static const uint32_t max_ticks = CLOCK_SPEED / FRAMERATE;
 
-        if(!SDL_GetQueuedAudioSize(_gb->apu.device_id)) {
+    _core.start();
+    take_state();
 
-            uint32_t frame_ticks = 0;
+    while(_core.is_running()) {
 
-            while(!_is_paused && frame_ticks < max_ticks) {
-
-                Emulator::execute_instr(_gb.get());
-                Emulator::update_ppu(_gb.get());
+        render();
 
-                if(_gb->cpu.is_double_speed) {
-                    Emulator::execute_instr(_gb.get());
-                    Emulator::update_ppu(_gb.get());
-                }
+        while(SDL_PollEvent(&event))
+            handle_event(event);
 
-                Emulator::update_timer(_gb.get());
-                Emulator::update_apu(_gb.get());
-                Emulator::check_interrupts(_gb.get());
+        take_state();
+    }
 
-                frame_ticks += _gb->cpu.ticks;
+    _core.stop();
+    Emulator::save_ram(_gb.get());
+}
 
-                if(is_breakpoint(_gb->cpu.reg.PC)) {
-                    window_disassembly->scroll_to_address(_gb->cpu.reg.PC);
-                    _is_paused = true;
-                }
+void Debugger::take_state() {
 
-                if(_next_stop_fall_thru == REG(PC) || _next_stop_jump == REG(PC)) {
-                    _next_stop_fall_thru = std::nullopt;
-                    _next_stop_jump = std::nullopt;
+    _state = &_core.take_state();
 
-                    window_disassembly->scroll_to_address(_gb->cpu.reg.PC);
-                    _is_paused = true;
-                }
-            }
-        }
+    // The core stopped by itself since the last state, show where
+    if(_state->stop_count != _stop_count) {
+        _stop_count = _state->stop_count;
 
-        render();
-
-        while(SDL_PollEvent(&event))
-            handle_event(event);
+        const auto disassembly_window = std::dynamic_pointer_cast<Windows::Disassembly>(_windows.at(WindowId::Disassembly));
+        disassembly_window->scroll_to_address(_state->gb()->cpu.reg.PC);
     }
-
-    Emulator::save_ram(_gb.get());
 }
 
-void Debugger::handle_event(SDL_Event event) const {
+void Debugger::handle_event(SDL_Event event) {
 
     ImGui_ImplSDL2_ProcessEvent(&event);
 
     switch(event.type) {
         case SDL_QUIT:
-            _gb->is_running = false;
+            quit();
             break;
 
         case SDL_WINDOWEVENT:
             if(event.window.event == SDL_WINDOWEVENT_CLOSE)
-                _gb->is_running = false;
+                quit();
             break;
 
         case SDL_KEYDOWN:
-            Emulator::set_key(_gb.get(), event.key.keysym.scancode, true);
-            break;
+        case SDL_KEYUP: {
+            const auto scancode = event.key.keysym.scancode;
+            const auto is_pressed = event.type == SDL_KEYDOWN;
 
-        case SDL_KEYUP:
-            Emulator::set_key(_gb.get(), event.key.keysym.scancode, false);
+            edit([scancode, is_pressed](Emulator::GameBoy *gb) {
+                Emulator::set_key(gb, scancode, is_pressed);
+            });
             break;
+        }
     }
 }
 
@@ -318,26 +322,70 @@ void Debugger::render() {
     SDL_GL_SwapWindow(_window);
 }
 
+// Checks the address as mapped in the current state, a banked breakpoint only shows in its own bank
 bool Debugger::is_breakpoint(const uint16_t addr) const {
-    return std::find(_breakpoints.begin(), _breakpoints.end(), addr) != _breakpoints.end();
+
+    const auto rom_bank = _state->gb()->mmu.rom_bank;
+
+    return std::any_of(_breakpoints.begin(), _breakpoints.end(), [addr, rom_bank](const Breakpoint &breakpoint) {
+        return breakpoint.address == addr && (!breakpoint.bank.has_value() || *breakpoint.bank == rom_bank);
+    });
 }
 
-void Debugger::add_breakpoint(const uint16_t addr) {
-    if(is_breakpoint(addr))
+void Debugger::add_breakpoint(const uint16_t addr, std::optional<uint16_t> bank) {
+
+    // Only the switchable ROM bank is qualified
+    if(addr < ROMNN_START || addr > ROMNN_END)
+        bank = std::nullopt;
+
+    const Breakpoint breakpoint = { addr, bank };
+
+    if(std::find(_breakpoints.begin(), _breakpoints.end(), breakpoint) != _breakpoints.end())
         return;
 
-    _breakpoints.push_back(addr);
+    _breakpoints.push_back(breakpoint);
+    _core.push(Core::AddBreakpoint { breakpoint });
 }
 
-void Debugger::remove_breakpoint(const uint16_t addr) {
-    for(size_t i = 0; i < _breakpoints.size(); ++i) {
-        if(_breakpoints[i] == addr) {
-            _breakpoints.erase(_breakpoints.begin() + i);
-            return;
-        }
-    }
+void Debugger::remove_breakpoint(const Breakpoint &breakpoint) {
+
+    const auto it = std::find(_breakpoints.begin(), _breakpoints.end(), breakpoint);
+
+    if(it == _breakpoints.end())
+        return;
+
+    _breakpoints.erase(it);
+    _core.push(Core::RemoveBreakpoint { breakpoint });
 }
 
-const std::vector<uint16_t>& Debugger::breakpoints() const {
+const std::vector<Debugger::Breakpoint> &Debugger::breakpoints() const {
     return _breakpoints;
 }
+
+const std::vector<Debugger::Watchpoint> &Debugger::watchpoints() const {
+    return _watchpoints;
+}
+
+const std::optional<Debugger::WatchpointHit> &Debugger::last_watchpoint_hit() const {
+    return _state->last_watchpoint_hit;
+}
+
+void Debugger::add_watchpoint(const Watchpoint &watchpoint) {
+
+    if(std::find(_watchpoints.begin(), _watchpoints.end(), watchpoint) != _watchpoints.end())
+        return;
+
+    _watchpoints.push_back(watchpoint);
+    _core.push(Core::AddWatchpoint { watchpoint });
+}
+
+void Debugger::remove_watchpoint(const Watchpoint &watchpoint) {
+
+    const auto it = std::find(_watchpoints.begin(), _watchpoints.end(), watchpoint);
+
+    if(it == _watchpoints.end())
+        return;
+
+    _watchpoints.erase(it);
+    _core.push(Core::RemoveWatchpoint { watchpoint });
+}
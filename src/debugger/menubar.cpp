@@ -16,7 +16,7 @@ void MenuBar::render() {
 
     if(ImGui::BeginMenu("jgbc")) {
         if(ImGui::MenuItem("Quit", "Alt+F4")) 
-            debugger().gb()->is_running = false;
+            debugger().quit();
 
         ImGui::EndMenu();
     }
@@ -26,7 +26,14 @@ void MenuBar::render() {
             debugger().set_paused(!debugger().is_paused());
 
         if(ImGui::MenuItem("Restart"))
-            Emulator::reset(debugger().gb().get());
+            debugger().reset();
+
+        const auto is_colour_corrected = debugger().state().gb()->ppu.is_colour_corrected;
+        if(ImGui::MenuItem("Colour Correction", nullptr, is_colour_corrected)) {
+            debugger().edit([is_colour_corrected](Emulator::GameBoy *gb) {
+                Emulator::set_colour_correction(gb, !is_colour_corrected);
+            });
+        }
 
         ImGui::EndMenu();
     }
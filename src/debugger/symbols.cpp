@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include "debugger/emulator.h"
+#include "debugger/symbols.h"
+
+
+// Replaces the symbols, sorted once after reading all of them
+bool Symbols::load(const std::string &path) {
+
+    std::ifstream file(path);
+
+    if(!file.is_open())
+        return false;
+
+    _symbols.clear();
+
+    std::string line;
+    while(std::getline(file, line)) {
+
+        if(line.empty() || line[0] == ';')
+            continue;
+
+        uint16_t bank;
+        uint16_t addr;
+        char name[101];
+
+        if(sscanf(line.c_str(), "%hX:%hX %100s", &bank, &addr, name) != 3)
+            continue;
+
+        _symbols.push_back({ bank, addr, name });
+    }
+
+    std::stable_sort(_symbols.begin(), _symbols.end(), [](const Symbol &a, const Symbol &b) {
+        return key(a.bank, a.address) < key(b.bank, b.address);
+    });
+
+    return true;
+}
+
+void Symbols::add(const uint16_t bank, const uint16_t address, const std::string &name) {
+    const auto it = lower_bound(bank, address + 1);
+    _symbols.insert(_symbols.begin() + (it - _symbols.cbegin()), { bank, address, name });
+}
+
+const std::vector<Symbols::Symbol> &Symbols::all() const {
+    return _symbols;
+}
+
+// Symbols of a bank from the start address up to the end address (excluded)
+std::pair<Symbols::Iterator, Symbols::Iterator> Symbols::range(const uint16_t bank, const uint16_t start, const uint32_t end) const {
+    return { lower_bound(bank, start), lower_bound(bank, end) };
+}
+
+// Last symbol at or before the address in the same bank and memory region
+const Symbols::Symbol *Symbols::nearest(const uint16_t bank, const uint16_t addr) const {
+
+    const auto it = lower_bound(bank, addr + 1);
+
+    if(it == _symbols.begin())
+        return nullptr;
+
+    const auto &symbol = *std::prev(it);
+
+    if(symbol.bank != bank || region(symbol.address) != region(addr))
+        return nullptr;
+
+    return &symbol;
+}
+
+// Name of the nearest symbol followed by the offset from it, the banked address if there is none
+std::string Symbols::name(const uint16_t bank, const uint16_t addr, const bool with_offset) const {
+
+    char buffer[16];
+    const auto *const symbol = nearest(bank, addr);
+
+    if(symbol != nullptr) {
+
+        if(symbol->address == addr || !with_offset)
+            return symbol->name;
+
+        snprintf(buffer, sizeof(buffer), "+0x%X", addr - symbol->address);
+        return symbol->name + buffer;
+    }
+
+    snprintf(buffer, sizeof(buffer), "%02X:%04X", bank, addr);
+    return buffer;
+}
+
+Symbols::Iterator Symbols::lower_bound(const uint16_t bank, const uint32_t addr) const {
+    return std::lower_bound(_symbols.begin(), _symbols.end(), key(bank, addr), [](const Symbol &symbol, const uint32_t value) {
+        return key(symbol.bank, symbol.address) < value;
+    });
+}
+
+// An address past the end of a bank is the start of the next one
+uint32_t Symbols::key(const uint16_t bank, const uint32_t addr) {
+    return (static_cast<uint32_t>(bank) << 16) + addr;
+}
+
+// The ROM banks are split, the other regions are told apart by their 8KB block
+int Symbols::region(const uint16_t addr) {
+
+    if(addr <= ROM00_END)
+        return 0;
+
+    if(addr <= ROMNN_END)
+        return 1;
+
+    return addr >> 13;
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cstring>
+#include "debugger/tile_cache.h"
+
+
+TileCache::~TileCache() {
+    for(auto &page : _pages)
+        glDeleteTextures(1, &page.texture_id);
+}
+
+// Returns the texture of the palette with every tile up to date
+ImTextureID TileCache::texture(const Emulator::GameBoy *gb, const Palette &palette) {
+
+    auto &page = this->page(gb, palette);
+    page.last_use = ++_use_count;
+    update(page, gb);
+
+    return reinterpret_cast<void *>(page.texture_id);
+}
+
+// Texture coordinates of a tile, a flipped tile has its coordinates swapped
+std::pair<ImVec2, ImVec2> TileCache::uv(const uint8_t bank, const uint16_t tile, const bool is_flipped_x, const bool is_flipped_y) {
+
+    const auto x = bank * TILES_PER_ROW * TILE_WIDTH + (tile % TILES_PER_ROW) * TILE_WIDTH;
+    const auto y = (tile / TILES_PER_ROW) * TILE_WIDTH;
+
+    auto start = ImVec2(static_cast<float>(x) / WIDTH, static_cast<float>(y) / HEIGHT);
+    auto end = ImVec2(static_cast<float>(x + TILE_WIDTH) / WIDTH, static_cast<float>(y + TILE_WIDTH) / HEIGHT);
+
+    if(is_flipped_x)
+        std::swap(start.x, end.x);
+
+    if(is_flipped_y)
+        std::swap(start.y, end.y);
+
+    return { start, end };
+}
+
+// Colours of a background palette, the monochrome GameBoy only has BGP
+TileCache::Palette TileCache::bg_palette(Emulator::GameBoy *gb, const uint8_t index) {
+
+    Palette palette {};
+
+    if(gb->cart.is_colour) {
+        std::copy_n(&gb->ppu.bg_colours[index * 4], 4, palette.begin());
+        return palette;
+    }
+
+    const auto value = SREAD8(BGP);
+
+    for(uint8_t i = 0; i < 4; ++i)
+        palette[i] = gb->ppu.shades[(value >> (i * 2)) & 0x3];
+
+    return palette;
+}
+
+// Colours of a sprite palette, OBP0 or OBP1 on the monochrome GameBoy
+TileCache::Palette TileCache::obj_palette(Emulator::GameBoy *gb, const uint8_t index) {
+
+    Palette palette {};
+
+    if(gb->cart.is_colour) {
+        std::copy_n(&gb->ppu.obj_colours[index * 4], 4, palette.begin());
+        return palette;
+    }
+
+    const auto value = SREAD8(index == 0 ? OBP0 : OBP1);
+
+    for(uint8_t i = 0; i < 4; ++i)
+        palette[i] = gb->ppu.shades[(value >> (i * 2)) & 0x3];
+
+    return palette;
+}
+
+// Finds the page of the palette, a new page has every tile out of date
+TileCache::Page &TileCache::page(const Emulator::GameBoy *gb, const Palette &palette) {
+
+    const auto it = std::find_if(_pages.begin(), _pages.end(), [&](const Page &page) {
+        return page.palette == palette;
+    });
+
+    if(it != _pages.end())
+        return *it;
+
+    Page *page;
+
+    if(_pages.size() < MAX_PAGES) {
+        page = &_pages.emplace_back();
+        page->pixels.resize(WIDTH * HEIGHT);
+
+        glGenTextures(1, &page->texture_id);
+        glBindTexture(GL_TEXTURE_2D, page->texture_id);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WIDTH, HEIGHT, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+    }
+    else {
+        page = &*std::min_element(_pages.begin(), _pages.end(), [](const Page &a, const Page &b) {
+            return a.last_use < b.last_use;
+        });
+    }
+
+    page->palette = palette;
+
+    for(uint8_t bank = 0; bank < VRAM_BANK_COUNT; ++bank)
+        for(uint16_t tile = 0; tile < VRAM_TILE_COUNT; ++tile)
+            page->versions[bank * VRAM_TILE_COUNT + tile] = ~gb->mmu.tile_versions[bank][tile];
+
+    return *page;
+}
+
+// Decodes the tiles written since the last update and uploads the rows of the texture they are in
+void TileCache::update(Page &page, const Emulator::GameBoy *gb) {
+
+    uint32_t first_line = HEIGHT;
+    uint32_t end_line = 0;
+
+    for(uint8_t bank = 0; bank < VRAM_BANK_COUNT; ++bank) {
+        for(uint16_t tile = 0; tile < VRAM_TILE_COUNT; ++tile) {
+
+            auto &version = page.versions[bank * VRAM_TILE_COUNT + tile];
+
+            if(version == gb->mmu.tile_versions[bank][tile])
+                continue;
+
+            version = gb->mmu.tile_versions[bank][tile];
+            decode_tile(gb, page.palette, bank, tile, page.pixels.data());
+
+            const auto line = (tile / TILES_PER_ROW) * TILE_WIDTH;
+            first_line = std::min(first_line, line);
+            end_line = std::max(end_line, line + TILE_WIDTH);
+        }
+    }
+
+    if(first_line >= end_line)
+        return;
+
+    glBindTexture(GL_TEXTURE_2D, page.texture_id);
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, 0, first_line, WIDTH, end_line - first_line,
+        GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, &page.pixels[first_line * WIDTH]
+    );
+}
+
+// Uses the same decoder as the PPU, one tile row per texture line
+void TileCache::decode_tile(const Emulator::GameBoy *gb, const Palette &palette, const uint8_t bank, const uint16_t tile, uint32_t *pixels) {
+
+    const auto *const data = &gb->mmu.vram_banks[bank][tile * VRAM_TILE_SIZE];
+    Emulator::TileRow rows[TILE_WIDTH];
+
+    for(uint8_t line = 0; line < TILE_WIDTH; ++line) {
+        rows[line].low = data[line * 2];
+        rows[line].high = data[line * 2 + 1];
+        rows[line].palette = palette.data();
+    }
+
+    uint32_t decoded[TILE_WIDTH * TILE_WIDTH];
+    gb->ppu.tile_decoder(rows, TILE_WIDTH, decoded);
+
+    const auto x = bank * TILES_PER_ROW * TILE_WIDTH + (tile % TILES_PER_ROW) * TILE_WIDTH;
+    const auto y = (tile / TILES_PER_ROW) * TILE_WIDTH;
+
+    for(uint8_t line = 0; line < TILE_WIDTH; ++line)
+        std::memcpy(&pixels[(y + line) * WIDTH + x], &decoded[line * TILE_WIDTH], TILE_WIDTH * sizeof(uint32_t));
+}
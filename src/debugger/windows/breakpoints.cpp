@@ -22,11 +22,18 @@ void Breakpoints::render() {
     ImGui::BeginChild("##scroll");
     const ImU32 step = 1, step_fast = 50;
     static uint32_t addr = 0;
+    static bool is_banked = false;
+    static uint16_t bank = 1;
     ImGui::InputScalar("ADDR", ImGuiDataType_U32, &addr, &step, &step_fast, "%04X", ImGuiInputTextFlags_CharsHexadecimal);
     ImGui::SameLine();
 
     if(ImGui::Button("Add"))
-        debugger().add_breakpoint(addr);
+        debugger().add_breakpoint(addr, is_banked ? std::optional<uint16_t>(bank) : std::nullopt);
+
+    // Switchable ROM breakpoints can be restricted to one bank
+    ImGui::Checkbox("In ROM bank", &is_banked);
+    ImGui::SameLine();
+    ImGui::InputScalar("BANK", ImGuiDataType_U16, &bank, &step, &step_fast, "%02X", ImGuiInputTextFlags_CharsHexadecimal);
 
     ImGui::Text("Presets");
 
@@ -57,16 +64,22 @@ void Breakpoints::render() {
     else {
 
         for(size_t i = 0; i < debugger().breakpoints().size(); ++i) {
-            const auto bp = debugger().breakpoints()[i];
+            const auto breakpoint = debugger().breakpoints()[i];
+            const auto bp = breakpoint.address;
 
-            ImGui::PushID(bp);
+            ImGui::PushID(static_cast<int>(i));
             if(ImGui::Button("X"))
-                debugger().remove_breakpoint(bp);
+                debugger().remove_breakpoint(breakpoint);
 
             ImGui::SameLine();
             ImGui::Text("%zu: ", i);
             ImGui::SameLine();
-            ImGui::TextColored(Colours::address, "0x%04X", bp);
+
+            if(breakpoint.bank.has_value())
+                ImGui::TextColored(Colours::address, "%02X:%04X", *breakpoint.bank, bp);
+            else
+                ImGui::TextColored(Colours::address, "0x%04X", bp);
+
             ImGui::SameLine();
 
             const auto instr = Emulator::find_instr(gb, bp);
@@ -96,10 +109,93 @@ void Breakpoints::render() {
         }
     }
 
+    ImGui::Separator();
+    render_watchpoints();
+
     ImGui::EndChild();
     ImGui::End();
 }
 
+void Breakpoints::render_watchpoints() {
+
+    ImGui::Text("Watchpoints");
+
+    const ImU32 step = 1, step_fast = 16;
+    static uint16_t start = 0, end = 0, bank = 1;
+    static uint8_t value = 0;
+    static bool on_read = false, on_write = true, is_banked = false, has_value = false;
+
+    ImGui::InputScalar("START", ImGuiDataType_U16, &start, &step, &step_fast, "%04X", ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::InputScalar("END", ImGuiDataType_U16, &end, &step, &step_fast, "%04X", ImGuiInputTextFlags_CharsHexadecimal);
+
+    ImGui::Checkbox("Read", &on_read);
+    ImGui::SameLine();
+    ImGui::Checkbox("Write", &on_write);
+
+    ImGui::Checkbox("In bank", &is_banked);
+    ImGui::SameLine();
+    ImGui::InputScalar("##bank", ImGuiDataType_U16, &bank, &step, &step_fast, "%02X", ImGuiInputTextFlags_CharsHexadecimal);
+
+    ImGui::Checkbox("Value", &has_value);
+    ImGui::SameLine();
+    ImGui::InputScalar("##value", ImGuiDataType_U8, &value, &step, &step_fast, "%02X", ImGuiInputTextFlags_CharsHexadecimal);
+
+    if(ImGui::Button("Add watchpoint") && (on_read || on_write)) {
+        debugger().add_watchpoint({
+            start,
+            end < start ? start : end,
+            is_banked ? std::optional<uint16_t>(bank) : std::nullopt,
+            on_read,
+            on_write,
+            has_value ? std::optional<uint8_t>(value) : std::nullopt
+        });
+    }
+
+    const auto &hit = debugger().last_watchpoint_hit();
+
+    if(hit.has_value()) {
+        ImGui::Text("Last hit:");
+        ImGui::SameLine();
+        ImGui::TextColored(Colours::address, "%02X:%04X", hit->bank, hit->address);
+        ImGui::SameLine();
+        ImGui::Text("%s %02X", hit->is_write ? "write" : "read", hit->value);
+    }
+
+    ImGui::Separator();
+
+    if(debugger().watchpoints().empty()) {
+        ImGui::Text("No watchpoints set");
+        return;
+    }
+
+    for(size_t i = 0; i < debugger().watchpoints().size(); ++i) {
+        const auto watchpoint = debugger().watchpoints()[i];
+
+        ImGui::PushID(static_cast<int>(i) + 0x10000);
+        if(ImGui::Button("X"))
+            debugger().remove_watchpoint(watchpoint);
+
+        ImGui::SameLine();
+        ImGui::Text("%zu: ", i);
+        ImGui::SameLine();
+
+        if(watchpoint.bank.has_value())
+            ImGui::TextColored(Colours::address, "%02X:%04X-%04X", *watchpoint.bank, watchpoint.start, watchpoint.end);
+        else
+            ImGui::TextColored(Colours::address, "0x%04X-0x%04X", watchpoint.start, watchpoint.end);
+
+        ImGui::SameLine();
+        ImGui::Text("%s%s", watchpoint.on_read ? "R" : "", watchpoint.on_write ? "W" : "");
+
+        if(watchpoint.value.has_value()) {
+            ImGui::SameLine();
+            ImGui::Text("== %02X", *watchpoint.value);
+        }
+
+        ImGui::PopID();
+    }
+}
+
 const char *Breakpoints::title() const {
     return "Breakpoints";
 }
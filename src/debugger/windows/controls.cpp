@@ -5,7 +5,7 @@
 using namespace Windows;
 
 Controls::Controls(Debugger &debugger) : Window(debugger) {
-
+    _speed = static_cast<int>(Debugger::Speed::Normal);
 }
 
 void Controls::render() {
@@ -33,7 +33,30 @@ void Controls::render() {
     ImGui::SameLine();
 
     if(ImGui::Button("Reset"))
-        Emulator::reset(debugger().gb().get());
+        debugger().reset();
+
+    // Unthrottled runs frames back to back, the audio drops what the device can't keep up with
+    if(ImGui::Combo("Speed", &_speed, "Normal\0Unthrottled\0"))
+        debugger().set_speed(static_cast<Debugger::Speed>(_speed));
+
+    INIT_GB_CTX();
+
+    // Waiting loops are skipped at once, stepping is unaffected
+    bool is_idle_skipped = gb->idle.is_enabled;
+    if(ImGui::Checkbox("Skip idle loops", &is_idle_skipped)) {
+        debugger().edit([is_idle_skipped](Emulator::GameBoy *gb) {
+            gb->idle.is_enabled = is_idle_skipped;
+            Emulator::reset_idle_loop(gb);
+        });
+    }
+
+    // Same results either way, for comparing against the plain decoder
+    bool is_instr_cached = gb->icache.is_enabled;
+    if(ImGui::Checkbox("Cache decoded instructions", &is_instr_cached)) {
+        debugger().edit([is_instr_cached](Emulator::GameBoy *gb) {
+            gb->icache.is_enabled = is_instr_cached;
+        });
+    }
 
     ImGui::End();
 }
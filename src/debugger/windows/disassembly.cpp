@@ -1,22 +1,41 @@
 #include <imgui.h>
+#include <algorithm>
+#include <cstring>
 #include "debugger/debugger.h"
 #include "debugger/colours.h"
 #include "debugger/windows/disassembly.h"
 
 using namespace Windows;
 
-// TODO: improve performance
+const std::pair<uint16_t, const char *> Disassembly::header_labels[HEADER_LABEL_COUNT] = {
+    { PROGRAM_START, "Program Start" },
+    { CART_HEADER_START + 4, "Cartridge Header" },
+    { CART_HEADER_TITLE, "Title" },
+    { CART_HEADER_GBC_FLAG, "GBC Flag" },
+    { CART_HEADER_TYPE, "Type" },
+    { CART_HEADER_ROM_SIZE, "ROM Size" },
+    { CART_HEADER_RAM_SIZE, "RAM Size" }
+};
 
 Disassembly::Disassembly(Debugger &debugger) : Window(debugger) {
     _address_to_scroll_to = PROGRAM_START;
-
-    _labels.emplace(PROGRAM_START, "Program Start");
-    _labels.emplace(CART_HEADER_START + 4, "Cartridge Header");
-    _labels.emplace(CART_HEADER_TITLE, "Title");
-    _labels.emplace(CART_HEADER_GBC_FLAG, "GBC Flag");
-    _labels.emplace(CART_HEADER_TYPE, "Type");
-    _labels.emplace(CART_HEADER_ROM_SIZE, "ROM Size");
-    _labels.emplace(CART_HEADER_RAM_SIZE, "RAM Size");
+    _line_count = 0;
+
+    _segments = {
+        { ROM00_START, ROM00_END, true, true },
+        { ROMNN_START, ROMNN_END, true, true },
+        { VRAM_START, VRAM_END, false, false },
+        { EXTRAM_START, EXTRAM_END, true, false },
+        { WRAM00_START, WRAM00_END, true, false },
+        { WRAMNN_START, WRAMNN_END, true, false },
+        { WRAM00_MIRROR_START, WRAM00_MIRROR_END, true, false },
+        { WRAMNN_MIRROR_START, WRAMNN_MIRROR_END, true, false },
+        { OAM_START, IO_END, false, false },
+        { HRAM_START, HRAM_END, true, false },
+        { IE_START_END, IE_START_END, false, false }
+    };
+
+    _selected_label = 0;
 }
 
 void Disassembly::render() {
@@ -33,58 +52,58 @@ void Disassembly::render() {
 
     ImGui::SameLine();
 
-    static uint16_t selected_label_addr = _labels.begin()->first;
-    if(ImGui::BeginCombo("Label", _labels.at(selected_label_addr).c_str())) {
+    const auto label_count = HEADER_LABEL_COUNT + debugger().symbols().all().size();
+
+    if(ImGui::BeginCombo("Label", label_name(_selected_label))) {
+
+        // There can be tens of thousands of symbols
+        ImGuiListClipper clipper(static_cast<int>(label_count));
 
-        for(const auto &[addr, name] : _labels) {
-            ImGui::PushID(reinterpret_cast<void *>(addr));
+        while(clipper.Step()) {
+            for(auto i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                ImGui::PushID(i);
 
-            if(ImGui::Selectable(name.c_str(), selected_label_addr == addr))
-                selected_label_addr = addr;
+                if(ImGui::Selectable(label_name(i), _selected_label == static_cast<size_t>(i)))
+                    _selected_label = i;
 
-            ImGui::PopID();
+                ImGui::PopID();
+            }
         }
 
+        clipper.End();
         ImGui::EndCombo();
     }
 
     ImGui::SameLine();
 
     if(ImGui::Button("Goto"))
-        _address_to_scroll_to = selected_label_addr;
+        _address_to_scroll_to = label_address(_selected_label);
+
+    update_index();
 
     ImGui::BeginChild("##scroll");
-    ImGuiListClipper clipper(line_count(0, UINT16_MAX));
+    ImGuiListClipper clipper(static_cast<int>(_line_count));
 
     // TODO: fix bug with display when label is placed at 0x0000
 
     while(clipper.Step()) {
 
         if(_address_to_scroll_to.has_value()) {
+            const auto address = _address_to_scroll_to.value();
             const auto offset = ImGui::GetTextLineHeightWithSpacing() *
-                    static_cast<float>(line_count(0, _address_to_scroll_to.value()) + _labels.size());
+                    static_cast<float>(line_of_address(address) + labels_before(address));
             ImGui::SetScrollFromPosY(ImGui::GetCursorStartPos().y + offset);
         }
 
-        auto addr = address_of_nth_line(0, clipper.DisplayStart);
-
         for(auto i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
 
-            for(const auto &[a, label] : _labels) {
-                if(addr == a) {
-                    ImGui::Text("%s:", label.c_str());
-                    break;
-                }
-            }
+            const auto addr = address_of_line(i);
+            draw_labels(addr);
 
-            if(is_executable(addr)) {
-                const auto instr = Emulator::find_instr(gb, addr);
-                draw_instr_line(addr, instr);
-                addr += instr.length;
-            } else {
+            if(is_executable(addr))
+                draw_instr_line(addr, Emulator::find_instr(gb, addr));
+            else
                 draw_data_line(addr);
-                addr++;
-            }
         }
     }
     
@@ -99,6 +118,21 @@ const char *Disassembly::title() const {
     return "Disassembly";
 }
 
+// Header labels and the symbols of the mapped bank at the address
+void Disassembly::draw_labels(const uint16_t addr) const {
+
+    INIT_GB_CTX();
+
+    for(const auto &[label_addr, name] : header_labels)
+        if(label_addr == addr)
+            ImGui::Text("%s:", name);
+
+    const auto [first, last] = debugger().symbols().range(Emulator::mapped_bank(gb, addr), addr, addr + 1);
+
+    for(auto it = first; it != last; ++it)
+        ImGui::Text("%s:", it->name.c_str());
+}
+
 void Disassembly::draw_instr_line(uint16_t addr, const Emulator::Instruction &instr) {
 
     INIT_GB_CTX();
@@ -147,9 +181,11 @@ void Disassembly::draw_instr_line(uint16_t addr, const Emulator::Instruction &in
         ImGui::SameLine(300);
         ImGui::TextColored(Colours::disassembly, instr.disassembly, operand);
 
-        if(label_addr > 0 && _labels.find(label_addr) != _labels.end()) {
+        const auto label_bank = Emulator::mapped_bank(gb, label_addr);
+
+        if(label_addr > 0 && debugger().symbols().nearest(label_bank, label_addr) != nullptr) {
             ImGui::SameLine();
-            ImGui::Text("[%s]", _labels.at(label_addr).c_str());
+            ImGui::Text("[%s]", debugger().symbols().name(label_bank, label_addr).c_str());
         }
     }
     // If there is no operand (or CB opcode which have no operand)
@@ -193,7 +229,7 @@ bool Disassembly::is_executable(const uint16_t addr) {
     return
         (addr <= 0x103 ||
         (addr > CART_HEADER_END && addr <= ROMNN_END) ||
-        (addr >= EXTRAM_START && addr <= OAM_START) ||
+        (addr >= EXTRAM_START && addr < OAM_START) ||
         (addr >= HRAM_START && addr <= HRAM_END));
 }
 
@@ -227,43 +263,205 @@ const char *Disassembly::get_region_label(const uint16_t addr) {
     return nullptr;
 }
 
-uint16_t Disassembly::address_of_nth_line(const uint16_t start_addr, const size_t n) const {
-    size_t count = 1;
+// Brings the index up to date, only the segments whose memory changed are decoded again
+void Disassembly::update_index() {
+
+    bool has_changed = false;
+
+    for(auto &segment : _segments)
+        has_changed |= update_segment(segment);
+
+    if(!has_changed)
+        return;
+
+    _line_count = 0;
+
+    for(auto &segment : _segments) {
+        segment.first_line = _line_count;
+        _line_count += segment.lines.size();
+    }
+}
+
+bool Disassembly::update_segment(Segment &segment) {
+
+    const size_t size = segment.end - segment.start + 1;
+
+    // Data is always one byte per line
+    if(!segment.is_executable) {
 
-    for(uint32_t addr = start_addr; addr <= 0xFFFF; count++) {
+        if(!segment.lines.empty())
+            return false;
 
-        if(is_executable(addr))
-            addr += Emulator::find_instr(debugger().gb().get(), addr).length;
-        else
-            addr++;
+        for(uint32_t addr = segment.start; addr <= segment.end; ++addr)
+            segment.lines.push_back(addr);
 
-        if(count == n)
-            return addr;
+        return true;
     }
 
-    return 0;
+    const auto *memory = segment_memory(segment);
+
+    // ROM contents only change with the bank
+    if(!segment.lines.empty() && memory == segment.memory &&
+       (segment.is_rom || memory == nullptr || std::memcmp(memory, segment.snapshot.data(), size) == 0))
+        return false;
+
+    std::vector<uint8_t> contents(size, 0xFF);
+
+    if(memory != nullptr)
+        std::memcpy(contents.data(), memory, size);
+
+    if(segment.lines.empty()) {
+        segment.snapshot = contents;
+        segment.memory = memory;
+        decode_segment(segment, segment.start, segment.end);
+        return true;
+    }
+
+    const auto mismatch = std::mismatch(contents.begin(), contents.end(), segment.snapshot.begin());
+    segment.memory = memory;
+
+    if(mismatch.first == contents.end())
+        return false;
+
+    size_t last = size - 1;
+    while(contents[last] == segment.snapshot[last])
+        last--;
+
+    const auto first = static_cast<size_t>(mismatch.first - contents.begin());
+    segment.snapshot = std::move(contents);
+
+    decode_segment(segment, segment.start + first, segment.start + last);
+    return true;
 }
 
-size_t Disassembly::line_count(const uint16_t from_addr, const uint16_t to_addr) const {
-    size_t count = 0;
+// Decodes again from the line containing the first changed byte
+// Once past the last changed byte, the decoding stops as soon as it lines up with the previous lines
+void Disassembly::decode_segment(Segment &segment, const uint16_t first_changed, const uint16_t last_changed) {
 
-    for(uint32_t addr = from_addr; addr <= to_addr;) {
+    auto &lines = segment.lines;
+    auto first = std::upper_bound(lines.begin(), lines.end(), first_changed);
 
-        if(is_executable(addr))
-            addr += Emulator::find_instr(debugger().gb().get(), addr).length;
-        else
-            addr++;
+    if(first != lines.begin())
+        --first;
 
-        count++;
+    uint32_t addr = first == lines.end() ? segment.start : *first;
+    auto resume = lines.end();
+    std::vector<uint16_t> decoded;
+
+    while(addr <= segment.end) {
+
+        if(addr > last_changed) {
+            const auto it = std::lower_bound(first, lines.end(), addr);
+
+            if(it != lines.end() && *it == addr) {
+                resume = it;
+                break;
+            }
+        }
+
+        decoded.push_back(addr);
+        addr += line_length(addr);
     }
 
-    return count;
+    std::vector<uint16_t> result;
+    result.reserve((first - lines.begin()) + decoded.size() + (lines.end() - resume));
+    result.insert(result.end(), lines.begin(), first);
+    result.insert(result.end(), decoded.begin(), decoded.end());
+    result.insert(result.end(), resume, lines.end());
+
+    lines = std::move(result);
+}
+
+const uint8_t *Disassembly::segment_memory(const Segment &segment) const {
+
+    const auto &mmu = debugger().state().gb()->mmu;
+
+    switch(segment.start) {
+        case ROM00_START: return mmu.rom00;
+        case ROMNN_START: return mmu.romNN;
+        case EXTRAM_START: return mmu.extram;
+        case WRAM00_START:
+        case WRAM00_MIRROR_START: return mmu.wram00;
+        case WRAMNN_START:
+        case WRAMNN_MIRROR_START: return mmu.wramNN;
+        case HRAM_START: return mmu.hram;
+        default: return nullptr;
+    }
+}
+
+uint16_t Disassembly::line_length(const uint16_t addr) const {
+
+    if(!is_executable(addr))
+        return 1;
+
+    return Emulator::find_instr(debugger().state().gb(), addr).length;
+}
+
+const Disassembly::Segment &Disassembly::segment_of_address(const uint16_t addr) const {
+
+    for(const auto &segment : _segments)
+        if(addr <= segment.end)
+            return segment;
+
+    return _segments.back();
+}
+
+uint16_t Disassembly::address_of_line(const size_t n) const {
+
+    const auto segment = std::upper_bound(_segments.begin(), _segments.end(), n, [](const size_t line, const Segment &s) {
+        return line < s.first_line;
+    }) - 1;
+
+    return segment->lines[std::min(n - segment->first_line, segment->lines.size() - 1)];
+}
+
+// Line showing an address, the line of the instruction containing it for operands
+size_t Disassembly::line_of_address(const uint16_t addr) const {
+
+    const auto &segment = segment_of_address(addr);
+    const auto line = std::upper_bound(segment.lines.begin(), segment.lines.end(), addr) - segment.lines.begin();
+
+    return segment.first_line + (line > 0 ? line - 1 : 0);
 }
 
 void Disassembly::scroll_to_address(const uint16_t address) {
     _address_to_scroll_to = address;
 }
 
-void Disassembly::add_label(const uint16_t address, const std::string &label) {
-    _labels.emplace(address, label);
+// Label lines shown above an address, the symbols of the banks that aren't mapped are hidden
+size_t Disassembly::labels_before(const uint16_t address) const {
+
+    INIT_GB_CTX();
+
+    auto count = static_cast<size_t>(std::count_if(std::begin(header_labels), std::end(header_labels), [address](const auto &label) {
+        return label.first < address;
+    }));
+
+    for(const auto &segment : _segments) {
+
+        if(segment.start >= address)
+            break;
+
+        const auto end = std::min<uint32_t>(segment.end + 1, address);
+        const auto [first, last] = debugger().symbols().range(Emulator::mapped_bank(gb, segment.start), segment.start, end);
+        count += std::distance(first, last);
+    }
+
+    return count;
+}
+
+const char *Disassembly::label_name(const size_t index) const {
+
+    if(index < HEADER_LABEL_COUNT)
+        return header_labels[index].second;
+
+    return debugger().symbols().all()[index - HEADER_LABEL_COUNT].name.c_str();
+}
+
+uint16_t Disassembly::label_address(const size_t index) const {
+
+    if(index < HEADER_LABEL_COUNT)
+        return header_labels[index].first;
+
+    return debugger().symbols().all()[index - HEADER_LABEL_COUNT].address;
 }
@@ -14,7 +14,7 @@ Framebuffer::Framebuffer(Debugger &debugger) : Window(debugger) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, debugger.gb()->ppu.framebuffer);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
 }
 
 Framebuffer::~Framebuffer() {
@@ -31,8 +31,13 @@ void Framebuffer::render() {
     const auto window_size = ImGui::GetContentRegionAvail();
     const auto scale = std::min(window_size.x / SCREEN_WIDTH, window_size.y / SCREEN_HEIGHT);
 
-    glBindTexture(GL_TEXTURE_2D, _texture_id);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, debugger().gb()->ppu.framebuffer);
+    // Only upload when the PPU has completed a new frame
+    const auto *const frame = Emulator::take_frame(debugger().gb().get());
+
+    if(frame != nullptr) {
+        glBindTexture(GL_TEXTURE_2D, _texture_id);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, frame);
+    }
 
     ImGui::Image(reinterpret_cast<void *>(_texture_id), ImVec2(SCREEN_WIDTH * scale, SCREEN_HEIGHT * scale));
     ImGui::End();
@@ -90,19 +90,19 @@ void IO::render() {
     ImGui::Separator();
     ImGui::NextColumn();
 
-    ImGui::Checkbox("Enabled", &gb->apu.square_waves[0].enabled);
+    draw_channel_enabled(0);
     const char *square_1_labels[5] = { "NR10", "NR11", "NR12", "NR13", "NR14" };
     const uint16_t square_1_addrs[5] = { NR10, NR11, NR12, NR13, NR14 };
     draw_values(square_1_labels, square_1_addrs, 5);
 
     ImGui::NextColumn();
-    ImGui::Checkbox("Enabled", &gb->apu.square_waves[1].enabled);
+    draw_channel_enabled(1);
     const char *square_2_labels[4] = { "NR21", "NR22", "NR23", "NR24" };
     const uint16_t square_2_addrs[4] = { NR21, NR22, NR23, NR24 };
     draw_values(square_2_labels, square_2_addrs, 4);
 
     ImGui::NextColumn();
-    ImGui::Checkbox("Enabled", &gb->apu.wave.enabled);
+    draw_channel_enabled(2);
     const char *wave_labels[4] = { "NR31", "NR32", "NR33", "NR34" };
     const uint16_t wave_addrs[4] = { NR31, NR32, NR33, NR34 };
     draw_values(wave_labels, wave_addrs, 4);
@@ -112,7 +112,7 @@ void IO::render() {
     ImGui::Text("Noise NR4X");
     ImGui::Separator();
 
-    ImGui::Checkbox("Enabled", &gb->apu.noise.enabled);
+    draw_channel_enabled(3);
     const char *noise_labels[4] = { "NR41", "NR42", "NR43", "NR44" };
     const uint16_t noise_addrs[4] = { NR41, NR42, NR43, NR44 };
     draw_values(noise_labels, noise_addrs, 4);
@@ -135,7 +135,7 @@ void IO::draw_values(const char **labels, const uint16_t *addrs, const int count
 
         int value = SREAD8(addrs[i]);
         if(ImGui::InputScalar(labels[i], ImGuiDataType_U32, &value, &step, &step_fast, "%02X", ImGuiInputTextFlags_CharsHexadecimal))
-            WRITE8(addrs[i], value);
+            debugger().write_memory(addrs[i], value, true);
     }
 }
 
@@ -144,7 +144,22 @@ void IO::draw_registers(const char **labels, const uint16_t regis, const uint8_t
 
     for(auto i = 0; i < count; ++i) {
         bool checked = Emulator::read_register(gb, regis, bits[i]);
-        if(ImGui::Checkbox(labels[i], &checked))
-            Emulator::write_register(gb, regis, bits[i], checked);
+        if(ImGui::Checkbox(labels[i], &checked)) {
+            const auto bit = bits[i];
+            debugger().edit([regis, bit, checked](Emulator::GameBoy *gb) { Emulator::write_register(gb, regis, bit, checked); });
+        }
     }
 }
+
+void IO::draw_channel_enabled(const int channel) const {
+    INIT_GB_CTX();
+
+    bool is_enabled = *channel_enabled(gb, channel);
+    if(ImGui::Checkbox("Enabled", &is_enabled))
+        debugger().edit([channel, is_enabled](Emulator::GameBoy *gb) { *channel_enabled(gb, channel) = is_enabled; });
+}
+
+bool *IO::channel_enabled(Emulator::GameBoy *gb, const int channel) {
+    bool *channels[4] = { &gb->apu.square_waves[0].enabled, &gb->apu.square_waves[1].enabled, &gb->apu.wave.enabled, &gb->apu.noise.enabled };
+    return channels[channel];
+}
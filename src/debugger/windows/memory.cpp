@@ -1,11 +1,23 @@
 #include <imgui.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include "debugger/debugger.h"
 #include "debugger/windows/memory.h"
 
 using namespace Windows;
 
+Memory *Memory::_instance = nullptr;
+
 Memory::Memory(Debugger &debugger) : Window(debugger) {
     _selected_idx = 0;
+    _change_reset = static_cast<int>(Debugger::ChangeReset::OnResume);
+    _is_heatmap_shown = false;
+
+    _instance = this;
+    _editor.WriteFn = &Memory::write_handler;
+    _editor.HighlightFn = &Memory::highlight_handler;
+    _editor.HighlightColor = IM_COL32(255, 80, 80, 110);
 }
 
 void Memory::render() {
@@ -29,9 +41,13 @@ void Memory::render() {
         ImGui::EndCombo();
     }
 
+    render_tracking();
+
     // Careful not to point to non existent extram
-    if(!(_offsets[_selected_idx] == EXTRAM_START && debugger().gb()->mmu.extram == nullptr))
-        _editor.DrawContents((void *) _regions[_selected_idx], _sizes[_selected_idx], _offsets[_selected_idx]);
+    const auto *const memory = region(_selected_idx);
+
+    if(memory != nullptr)
+        _editor.DrawContents((void *) memory, _sizes[_selected_idx], _offsets[_selected_idx]);
     else
         ImGui::Text("EXTRAM not available.");
 
@@ -41,3 +57,144 @@ void Memory::render() {
 const char *Memory::title() const {
     return "Memory";
 }
+
+// The changed bytes are highlighted in the editor, the write counts per page are shown as a heatmap
+void Memory::render_tracking() {
+
+    INIT_GB_CTX();
+
+    bool is_tracking = gb->mmu.writes.is_enabled;
+    if(ImGui::Checkbox("Track writes", &is_tracking)) {
+        debugger().edit([is_tracking](Emulator::GameBoy *gb) {
+            if(is_tracking)
+                Emulator::start_write_tracking(gb);
+            else
+                Emulator::stop_write_tracking(gb);
+        });
+    }
+
+    if(!is_tracking)
+        return;
+
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80.0f);
+
+    if(ImGui::Combo("Changed since", &_change_reset, "Resume\0Frame\0"))
+        debugger().set_change_reset(static_cast<Debugger::ChangeReset>(_change_reset));
+
+    ImGui::SameLine();
+
+    if(ImGui::Button("Clear")) {
+        debugger().edit([](Emulator::GameBoy *gb) {
+            Emulator::clear_changed_bytes(gb);
+            Emulator::clear_write_counts(gb);
+        });
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Heatmap", &_is_heatmap_shown);
+
+    if(_is_heatmap_shown)
+        render_heatmap();
+}
+
+// One cell per page, a row per 4KB, clicking a page shows it in the editor
+void Memory::render_heatmap() {
+
+    INIT_GB_CTX();
+
+    static constexpr uint32_t PAGES_PER_ROW = 16;
+
+    const auto &counts = gb->mmu.writes.page_counts;
+    const auto max_count = *std::max_element(std::begin(counts), std::end(counts));
+
+    // Logarithmic so the pages written a few times still stand out from the unwritten ones
+    const auto max_intensity = std::log1p(static_cast<float>(max_count));
+
+    auto *const draw_list = ImGui::GetWindowDrawList();
+    const auto origin = ImGui::GetCursorScreenPos();
+    const auto cells = ImVec2(origin.x + HEATMAP_MARGIN, origin.y);
+
+    for(uint32_t page = 0; page < WRITE_PAGE_COUNT; ++page) {
+
+        const auto x = cells.x + (page % PAGES_PER_ROW) * HEATMAP_CELL_SIZE;
+        const auto y = cells.y + (page / PAGES_PER_ROW) * HEATMAP_CELL_SIZE;
+
+        ImU32 colour = IM_COL32(40, 40, 40, 255);
+
+        if(counts[page] > 0) {
+            const auto intensity = std::log1p(static_cast<float>(counts[page])) / max_intensity;
+            colour = IM_COL32(static_cast<int>(255 * intensity), 60, static_cast<int>(255 * (1.0f - intensity)), 255);
+        }
+
+        draw_list->AddRectFilled(ImVec2(x, y), ImVec2(x + HEATMAP_CELL_SIZE - 1.0f, y + HEATMAP_CELL_SIZE - 1.0f), colour);
+
+        if(page % PAGES_PER_ROW == 0) {
+            char label[8];
+            snprintf(label, sizeof(label), "%04X", page * WRITE_PAGE_SIZE);
+            draw_list->AddText(ImVec2(origin.x, y - 2.0f), IM_COL32(200, 200, 200, 255), label);
+        }
+    }
+
+    const auto size = ImVec2(PAGES_PER_ROW * HEATMAP_CELL_SIZE, WRITE_PAGE_COUNT / PAGES_PER_ROW * HEATMAP_CELL_SIZE);
+    ImGui::SetCursorScreenPos(cells);
+    ImGui::InvisibleButton("##heatmap", size);
+
+    if(!ImGui::IsItemHovered())
+        return;
+
+    const auto mouse = ImGui::GetMousePos();
+    const auto column = std::min<uint32_t>(static_cast<uint32_t>((mouse.x - cells.x) / HEATMAP_CELL_SIZE), PAGES_PER_ROW - 1);
+    const auto row = std::min<uint32_t>(static_cast<uint32_t>((mouse.y - cells.y) / HEATMAP_CELL_SIZE), PAGES_PER_ROW - 1);
+    const auto page = row * PAGES_PER_ROW + column;
+    const auto address = static_cast<uint16_t>(page * WRITE_PAGE_SIZE);
+
+    ImGui::SetTooltip("%04X-%04X: %u writes", address, address + WRITE_PAGE_SIZE - 1, counts[page]);
+
+    if(!ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+        return;
+
+    const auto index = region_of(address);
+
+    if(!index.has_value())
+        return;
+
+    _selected_idx = *index;
+
+    const auto offset = address - _offsets[_selected_idx];
+    _editor.GotoAddrAndHighlight(offset, std::min<size_t>(offset + WRITE_PAGE_SIZE, _sizes[_selected_idx]));
+}
+
+const uint8_t *Memory::region(const size_t index) const {
+
+    const auto &mmu = debugger().state().gb()->mmu;
+    const uint8_t *regions[REGION_COUNT] = { mmu.rom00, mmu.romNN, mmu.vram, mmu.extram, mmu.wram00, mmu.wramNN, mmu.oam, mmu.io, mmu.hram };
+
+    return regions[index];
+}
+
+// Region containing an address, the echo RAM and the unusable area aren't shown
+std::optional<size_t> Memory::region_of(const uint16_t address) const {
+
+    for(size_t i = 0; i < REGION_COUNT; ++i)
+        if(address >= _offsets[i] && address < _offsets[i] + _sizes[i])
+            return i;
+
+    return std::nullopt;
+}
+
+void Memory::write_handler(uint8_t *, const size_t offset, const uint8_t value) {
+    const auto addr = _instance->_offsets[_instance->_selected_idx] + offset;
+    _instance->debugger().write_memory(static_cast<uint16_t>(addr), value);
+}
+
+bool Memory::highlight_handler(const uint8_t *, const size_t offset) {
+
+    const auto *const gb = _instance->debugger().state().gb();
+
+    if(!gb->mmu.writes.is_enabled)
+        return false;
+
+    const auto addr = _instance->_offsets[_instance->_selected_idx] + offset;
+    return Emulator::is_byte_changed(gb, static_cast<uint16_t>(addr));
+}
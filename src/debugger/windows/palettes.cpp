@@ -32,14 +32,12 @@ void Palettes::render() {
             {
                 ImGui::SameLine();
 
+                // The converted colours share the packed layout of ImU32
                 const auto colour = type == 0
-                    ? debugger().gb()->ppu.bg_palette[palette * 4 + i]
-                    : debugger().gb()->ppu.obj_palette[palette * 4 + i];
+                    ? debugger().state().gb()->ppu.bg_colours[palette * 4 + i]
+                    : debugger().state().gb()->ppu.obj_colours[palette * 4 + i];
 
-                ImVec4 colour_vec;
-                colour_vec.x = (colour & 0x1F) / 31.0f;
-                colour_vec.y = ((colour & 0x3E0) >> 5) / 31.0f;
-                colour_vec.z = ((colour & 0x7C00) >> 10) / 31.0f;
+                const auto colour_vec = ImGui::ColorConvertU32ToFloat4(colour);
 
                 ImGui::ColorButton(
                     "##button",
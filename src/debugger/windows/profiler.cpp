@@ -0,0 +1,425 @@
+#include <imgui.h>
+#include <algorithm>
+#include <map>
+#include "debugger/debugger.h"
+#include "debugger/colours.h"
+#include "debugger/windows/profiler.h"
+
+using namespace Windows;
+
+template<typename T>
+static int compare(const T &a, const T &b) {
+    return (a > b) - (a < b);
+}
+
+
+Profiler::Profiler(Debugger &debugger) : Window(debugger) {
+    _is_pending_ready = false;
+    _is_requested = false;
+    _frames_since_request = 0;
+
+    _max_depth = 0;
+    _zoom_node = 0;
+    _is_sort_dirty = false;
+}
+
+void Profiler::render() {
+
+    if(!ImGui::Begin(title())) {
+        ImGui::End();
+        return;
+    }
+
+    INIT_GB_CTX();
+
+    bool is_enabled = gb->profiler.is_enabled;
+    if(ImGui::Checkbox("Enabled", &is_enabled)) {
+        debugger().edit([is_enabled](Emulator::GameBoy *gb) {
+            if(is_enabled)
+                Emulator::start_profiler(gb);
+            else
+                Emulator::stop_profiler(gb);
+        });
+    }
+
+    ImGui::SameLine();
+
+    if(ImGui::Button("Clear")) {
+        debugger().edit([](Emulator::GameBoy *gb) { Emulator::clear_profiler(gb); });
+        request_snapshot();
+    }
+
+    ImGui::SameLine();
+
+    if(ImGui::Button("Refresh"))
+        request_snapshot();
+
+    if(is_enabled && ++_frames_since_request >= REFRESH_FRAMES)
+        request_snapshot();
+
+    take_snapshot();
+
+    ImGui::SameLine();
+    ImGui::Text(
+        "%llu cycles, %.2f%% halted",
+        static_cast<unsigned long long>(_snapshot.cycles),
+        percent(_snapshot.halted_cycles)
+    );
+
+    if(ImGui::BeginTabBar("##views")) {
+
+        if(ImGui::BeginTabItem("Functions")) {
+            render_functions();
+            ImGui::EndTabItem();
+        }
+
+        if(ImGui::BeginTabItem("Symbols")) {
+            render_symbols();
+            ImGui::EndTabItem();
+        }
+
+        if(ImGui::BeginTabItem("Flamegraph")) {
+            render_flamegraph();
+            ImGui::EndTabItem();
+        }
+
+        ImGui::EndTabBar();
+    }
+
+    ImGui::End();
+}
+
+const char *Profiler::title() const {
+    return "Profiler";
+}
+
+// Copies the counters on the core thread, only the executed addresses are kept
+void Profiler::request_snapshot() {
+
+    _frames_since_request = 0;
+
+    if(_is_requested)
+        return;
+
+    _is_requested = true;
+
+    debugger().edit([this](Emulator::GameBoy *gb) {
+        const auto &profiler = gb->profiler;
+
+        _pending.samples.clear();
+        _pending.nodes.clear();
+
+        if(profiler.rom_cycles != nullptr) {
+            _pending.cycles = profiler.cycles;
+            _pending.halted_cycles = profiler.halted_cycles;
+
+            const auto rom_size = static_cast<uint32_t>(gb->cart.rom_size) * ROM_BANK_SIZE;
+
+            for(uint32_t i = 0; i < rom_size; ++i) {
+
+                if(profiler.rom_cycles[i] == 0)
+                    continue;
+
+                // Bank 0 is the fixed bank, the others are switched in at ROMNN_START
+                const auto bank = static_cast<uint16_t>(i / ROM_BANK_SIZE);
+                const auto address = static_cast<uint16_t>(bank == 0 ? i : ROMNN_START + i % ROM_BANK_SIZE);
+                _pending.samples.push_back({ bank, address, profiler.rom_cycles[i] });
+            }
+
+            for(uint32_t i = 0; i < PROFILE_RAM_SIZE; ++i) {
+                if(profiler.ram_cycles[i] > 0)
+                    _pending.samples.push_back({ 0, static_cast<uint16_t>(PROFILE_RAM_START + i), profiler.ram_cycles[i] });
+            }
+
+            _pending.nodes.assign(profiler.nodes, profiler.nodes + profiler.node_count);
+        }
+
+        _is_pending_ready.store(true, std::memory_order_release);
+    });
+}
+
+void Profiler::take_snapshot() {
+
+    if(!_is_pending_ready.load(std::memory_order_acquire))
+        return;
+
+    std::swap(_snapshot, _pending);
+    _is_pending_ready = false;
+    _is_requested = false;
+
+    if(_zoom_node >= _snapshot.nodes.size())
+        _zoom_node = 0;
+
+    build_call_tree();
+    build_functions();
+    build_symbols();
+    _is_sort_dirty = true;
+}
+
+void Profiler::build_call_tree() {
+
+    const auto &nodes = _snapshot.nodes;
+    const auto count = nodes.size();
+
+    _node_names.resize(count);
+    _node_cycles.resize(count);
+    _children.assign(count, {});
+
+    std::vector<uint32_t> depths(count, 0);
+    _max_depth = 0;
+
+    for(size_t i = 0; i < count; ++i) {
+        _node_names[i] = i == 0 ? "(top level)" : debugger().symbols().name(nodes[i].bank, nodes[i].address);
+        _node_cycles[i] = nodes[i].cycles;
+
+        if(i > 0) {
+            depths[i] = depths[nodes[i].parent] + 1;
+            _max_depth = std::max(_max_depth, depths[i]);
+        }
+    }
+
+    // A node is always added after its parent
+    for(auto i = count; i-- > 1;) {
+        _node_cycles[nodes[i].parent] += _node_cycles[i];
+        _children[nodes[i].parent].push_back(static_cast<uint32_t>(i));
+    }
+
+    for(auto &children : _children) {
+        std::sort(children.begin(), children.end(), [this](const uint32_t a, const uint32_t b) {
+            return _node_cycles[a] > _node_cycles[b];
+        });
+    }
+}
+
+void Profiler::build_functions() {
+
+    const auto &nodes = _snapshot.nodes;
+    std::map<uint32_t, Function> functions; // Bank in the upper 16 bits
+
+    for(size_t i = 0; i < nodes.size(); ++i) {
+
+        const auto &node = nodes[i];
+        const auto key = static_cast<uint32_t>(node.bank) << 16 | node.address;
+        auto [it, is_new] = functions.try_emplace(key);
+        auto &function = it->second;
+
+        if(is_new)
+            function = { _node_names[i], node.bank, node.address, 0, 0, 0 };
+
+        function.calls += node.calls;
+        function.self_cycles += node.cycles;
+
+        // The calls a recursive routine makes to itself are already in its total
+        bool is_recursive = false;
+
+        for(auto parent = i; parent != 0 && !is_recursive;) {
+            parent = nodes[parent].parent;
+            is_recursive = parent != 0 && nodes[parent].bank == node.bank && nodes[parent].address == node.address;
+        }
+
+        if(!is_recursive)
+            function.total_cycles += _node_cycles[i];
+    }
+
+    _functions.clear();
+
+    for(auto &[key, function] : functions)
+        _functions.push_back(std::move(function));
+}
+
+void Profiler::build_symbols() {
+
+    std::map<std::string, uint64_t> symbols;
+
+    for(const auto &sample : _snapshot.samples)
+        symbols[debugger().symbols().name(sample.bank, sample.address, false)] += sample.cycles;
+
+    _symbols.clear();
+
+    for(auto &[name, cycles] : symbols)
+        _symbols.push_back({ name, cycles });
+
+    std::sort(_symbols.begin(), _symbols.end(), [](const SymbolCycles &a, const SymbolCycles &b) {
+        return a.cycles > b.cycles;
+    });
+}
+
+void Profiler::render_functions() {
+
+    static constexpr auto flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+        ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable | ImGuiTableFlags_SizingFixedFit;
+
+    if(!ImGui::BeginTable("##functions", 7, flags))
+        return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Function", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Address");
+    ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_PreferSortDescending);
+    ImGui::TableSetupColumn("Self", ImGuiTableColumnFlags_PreferSortDescending);
+    ImGui::TableSetupColumn("Self %", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_DefaultSort);
+    ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_PreferSortDescending);
+    ImGui::TableSetupColumn("Total %", ImGuiTableColumnFlags_PreferSortDescending);
+    ImGui::TableHeadersRow();
+
+    auto *const specs = ImGui::TableGetSortSpecs();
+
+    if(specs != nullptr && specs->SpecsCount > 0 && (specs->SpecsDirty || _is_sort_dirty)) {
+
+        const auto column = specs->Specs[0].ColumnIndex;
+        const auto is_ascending = specs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+
+        std::sort(_functions.begin(), _functions.end(), [column, is_ascending](const Function &a, const Function &b) {
+            int order;
+
+            switch(column) {
+                case 0: order = a.name.compare(b.name); break;
+                case 1: order = compare(a.bank << 16 | a.address, b.bank << 16 | b.address); break;
+                case 2: order = compare(a.calls, b.calls); break;
+                case 3: case 4: order = compare(a.self_cycles, b.self_cycles); break;
+                default: order = compare(a.total_cycles, b.total_cycles); break;
+            }
+
+            return is_ascending ? order < 0 : order > 0;
+        });
+
+        specs->SpecsDirty = false;
+        _is_sort_dirty = false;
+    }
+
+    ImGuiListClipper clipper(static_cast<int>(_functions.size()));
+
+    while(clipper.Step()) {
+        for(auto i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+
+            const auto &function = _functions[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(function.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextColored(Colours::address, "%02X:%04X", function.bank, function.address);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", function.calls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(function.self_cycles));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", percent(function.self_cycles));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(function.total_cycles));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", percent(function.total_cycles));
+        }
+    }
+
+    clipper.End();
+    ImGui::EndTable();
+}
+
+void Profiler::render_symbols() {
+
+    static constexpr auto flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+        ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingFixedFit;
+
+    if(!ImGui::BeginTable("##symbols", 3, flags))
+        return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Symbol", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Cycles");
+    ImGui::TableSetupColumn("%");
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper(static_cast<int>(_symbols.size()));
+
+    while(clipper.Step()) {
+        for(auto i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+
+            const auto &symbol = _symbols[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(symbol.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(symbol.cycles));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", percent(symbol.cycles));
+        }
+    }
+
+    clipper.End();
+    ImGui::EndTable();
+}
+
+// The callers are above the routines they call, click on a routine to zoom in
+void Profiler::render_flamegraph() {
+
+    if(_snapshot.nodes.empty())
+        return;
+
+    if(ImGui::Button("Zoom out"))
+        _zoom_node = _snapshot.nodes[_zoom_node].parent;
+
+    ImGui::SameLine();
+    ImGui::TextUnformatted(_node_names[_zoom_node].c_str());
+
+    ImGui::BeginChild("##flamegraph");
+
+    const auto origin = ImGui::GetCursorScreenPos();
+    const auto width = ImGui::GetContentRegionAvail().x;
+
+    draw_node(_zoom_node, origin.x, origin.y, width, 0);
+    ImGui::Dummy(ImVec2(width, ImGui::GetTextLineHeightWithSpacing() * static_cast<float>(_max_depth + 1)));
+
+    ImGui::EndChild();
+}
+
+// A routine is as wide as the cycles spent in it and in the routines it called
+void Profiler::draw_node(const uint32_t node, const float x, const float y, const float width, const uint32_t depth) {
+
+    if(width < 1.0f || _node_cycles[node] == 0)
+        return;
+
+    auto *const draw_list = ImGui::GetWindowDrawList();
+    const auto height = ImGui::GetTextLineHeightWithSpacing();
+
+    const ImVec2 min(x, y + height * static_cast<float>(depth));
+    const ImVec2 max(x + width - 1.0f, min.y + height - 1.0f);
+
+    // Warm colours that stay the same for a routine
+    const auto hash = static_cast<uint32_t>(_snapshot.nodes[node].address) * 2654435761u;
+    const auto colour = IM_COL32(205 + (hash >> 8) % 50, 80 + (hash >> 16) % 120, 40 + (hash >> 24) % 40, 255);
+
+    draw_list->AddRectFilled(min, max, colour);
+    draw_list->PushClipRect(min, max, true);
+    draw_list->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32(0, 0, 0, 255), _node_names[node].c_str());
+    draw_list->PopClipRect();
+
+    if(ImGui::IsWindowHovered() && ImGui::IsMouseHoveringRect(min, max)) {
+
+        ImGui::SetTooltip(
+            "%s\n%llu cycles (%.2f%%)\n%u calls",
+            _node_names[node].c_str(),
+            static_cast<unsigned long long>(_node_cycles[node]),
+            percent(_node_cycles[node]),
+            _snapshot.nodes[node].calls
+        );
+
+        if(ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+            _zoom_node = node;
+    }
+
+    auto child_x = x;
+
+    for(const auto child : _children[node]) {
+        const auto child_width = width * static_cast<float>(_node_cycles[child]) / static_cast<float>(_node_cycles[node]);
+        draw_node(child, child_x, y, child_width, depth + 1);
+        child_x += child_width;
+    }
+}
+
+float Profiler::percent(const uint64_t cycles) const {
+    return _snapshot.cycles == 0 ? 0.0f : 100.0f * static_cast<float>(cycles) / static_cast<float>(_snapshot.cycles);
+}
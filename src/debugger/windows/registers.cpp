@@ -26,13 +26,12 @@ void Registers::render() {
     ImGui::Separator();
 
     const char *cpu_reg_labels[6] = { "AF", "BC", "DE", "HL", "SP", "PC" };
-    uint16_t *cpu_reg_addr[6] = { &REG(AF), &REG(BC), &REG(DE), &REG(HL), &REG(SP), &REG(PC) };
 
     const ImU32 step = 1, step_fast = 10;
     for(auto i = 0; i < 6; ++i) {
-        int value = *cpu_reg_addr[i];
+        int value = *cpu_register(gb, i);
         if(ImGui::InputScalar(cpu_reg_labels[i], ImGuiDataType_U32, &value, &step, &step_fast, "%04X", ImGuiInputTextFlags_CharsHexadecimal))
-            *cpu_reg_addr[i] = value;
+            debugger().edit([i, value](Emulator::GameBoy *gb) { *cpu_register(gb, i) = value; });
     }
 
     ImGui::NextColumn();
@@ -42,12 +41,12 @@ void Registers::render() {
     for(auto i = 0; i < 5; ++i) {
         int value = io_reg_addr[i];
         if(ImGui::InputScalar(io_reg_labels[i], ImGuiDataType_U32, &value, &step, &step_fast, "%02X", ImGuiInputTextFlags_CharsHexadecimal))
-            SWRITE8(io_reg_addr[i], value);
+            debugger().write_memory(io_reg_addr[i], value);
     }
 
     bool ime = REG(IME);
     if(ImGui::Checkbox("IME", &ime))
-        REG(IME) = ime;
+        debugger().edit([ime](Emulator::GameBoy *gb) { REG(IME) = ime; });
 
     ImGui::Columns(1);
     ImGui::Separator();
@@ -59,24 +58,30 @@ void Registers::render() {
 
     ImGui::Text("FLAGS");
     if(ImGui::Checkbox("Z", &flag_zero))
-        FSET(FLAG_ZERO, flag_zero);
+        debugger().edit([flag_zero](Emulator::GameBoy *gb) { FSET(FLAG_ZERO, flag_zero); });
 
     ImGui::SameLine();
     if(ImGui::Checkbox("N", &flag_subtract))
-        FSET(FLAG_SUBTRACT, flag_subtract);
+        debugger().edit([flag_subtract](Emulator::GameBoy *gb) { FSET(FLAG_SUBTRACT, flag_subtract); });
 
     ImGui::SameLine();
     if(ImGui::Checkbox("H", &flag_halfcarry))
-        FSET(FLAG_HALFCARRY, flag_halfcarry);
+        debugger().edit([flag_halfcarry](Emulator::GameBoy *gb) { FSET(FLAG_HALFCARRY, flag_halfcarry); });
 
     ImGui::SameLine();
     if(ImGui::Checkbox("C", &flag_carry))
-        FSET(FLAG_CARRY, flag_carry);
+        debugger().edit([flag_carry](Emulator::GameBoy *gb) { FSET(FLAG_CARRY, flag_carry); });
 
     ImGui::Separator();
     ImGui::Text("STATE");
-    ImGui::Checkbox("Halted", &gb->cpu.is_halted);
-    ImGui::Checkbox("Double Speed", &gb->cpu.is_double_speed);
+
+    bool is_halted = gb->cpu.is_halted;
+    if(ImGui::Checkbox("Halted", &is_halted))
+        debugger().edit([is_halted](Emulator::GameBoy *gb) { gb->cpu.is_halted = is_halted; });
+
+    bool is_double_speed = gb->cpu.is_double_speed;
+    if(ImGui::Checkbox("Double Speed", &is_double_speed))
+        debugger().edit([is_double_speed](Emulator::GameBoy *gb) { gb->cpu.is_double_speed = is_double_speed; });
 
     ImGui::End();
 }
@@ -84,3 +89,8 @@ void Registers::render() {
 const char *Registers::title() const {
     return "Registers";
 }
+
+uint16_t *Registers::cpu_register(Emulator::GameBoy *gb, const int index) {
+    uint16_t *registers[6] = { &REG(AF), &REG(BC), &REG(DE), &REG(HL), &REG(SP), &REG(PC) };
+    return registers[index];
+}
@@ -4,6 +4,7 @@
 using namespace Windows;
 
 std::stringstream Serial::_buffer;
+Queue<uint8_t, Serial::PENDING_CAPACITY> Serial::_pending;
 
 Serial::Serial(Debugger &debugger) : Window(debugger) {
 
@@ -11,6 +12,9 @@ Serial::Serial(Debugger &debugger) : Window(debugger) {
 
 void Serial::render() {
 
+    while(const auto data = _pending.pop())
+        _buffer << static_cast<char>(*data);
+
     if(!ImGui::Begin(title())) {
         ImGui::End();
         return;
@@ -30,6 +34,7 @@ const char *Serial::title() const {
     return "Serial Output";
 }
 
+// Called on the core thread, bytes are dropped if the window doesn't keep up
 void Serial::serial_write_handler(const uint8_t data) {
-    _buffer << static_cast<char>(data);
+    _pending.push(uint8_t { data });
 }
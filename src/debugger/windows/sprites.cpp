@@ -0,0 +1,183 @@
+#include <imgui.h>
+#include "debugger/debugger.h"
+#include "debugger/colours.h"
+#include "debugger/windows/sprites.h"
+
+using namespace Windows;
+
+Sprites::Sprites(Debugger &debugger) : Window(debugger) {
+    _is_hidden_shown = true;
+}
+
+void Sprites::render() {
+
+    if(!ImGui::Begin(title())) {
+        ImGui::End();
+        return;
+    }
+
+    INIT_GB_CTX();
+    const bool is_tall = RREG(LCDC, LCDC_OBJ_SIZE);
+
+    ImGui::Text("Size: 8x%d", is_tall ? 16 : 8);
+    ImGui::SameLine();
+    ImGui::Checkbox("Off screen", &_is_hidden_shown);
+
+    render_screen(gb, is_tall);
+
+    static constexpr auto flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+
+    if(!ImGui::BeginTable("##sprites", 8, flags)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("#");
+    ImGui::TableSetupColumn("Tile");
+    ImGui::TableSetupColumn("Address");
+    ImGui::TableSetupColumn("X");
+    ImGui::TableSetupColumn("Y");
+    ImGui::TableSetupColumn("Number");
+    ImGui::TableSetupColumn("Palette");
+    ImGui::TableSetupColumn("Flags", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    for(uint8_t i = 0; i < SPRITE_COUNT; ++i) {
+
+        const auto *const entry = &gb->mmu.oam[i * 4];
+        const auto y = entry[0];
+        const auto x = entry[1];
+
+        // Sprites are hidden by moving them off the screen
+        if(!_is_hidden_shown && (x == 0 || x >= SCREEN_WIDTH + 8 || y == 0 || y >= SCREEN_HEIGHT + 16))
+            continue;
+
+        const auto attributes = entry[3];
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%d", i);
+        ImGui::TableNextColumn();
+        render_sprite(gb, i, is_tall);
+        ImGui::TableNextColumn();
+        ImGui::TextColored(Colours::address, "%04X", OAM_START + i * 4);
+        ImGui::TableNextColumn();
+        ImGui::Text("%d", x - 8);
+        ImGui::TableNextColumn();
+        ImGui::Text("%d", y - 16);
+        ImGui::TableNextColumn();
+        ImGui::TextColored(Colours::data, "%02X", entry[2]);
+        ImGui::TableNextColumn();
+
+        if(gb->cart.is_colour)
+            ImGui::Text("OBJ %d, bank %d", attributes & TILE_ATTR_PALETTE, (attributes & TILE_ATTR_BANK) ? 1 : 0);
+        else
+            ImGui::Text("OBP%d", (attributes >> SPRITE_ATTR_PALETTE) & 1);
+
+        ImGui::TableNextColumn();
+        ImGui::Text(
+            "%02X%s%s%s",
+            attributes,
+            (attributes >> SPRITE_ATTR_FLIP_X) & 1 ? " flip X" : "",
+            (attributes >> SPRITE_ATTR_FLIP_Y) & 1 ? " flip Y" : "",
+            (attributes >> SPRITE_ATTR_PRIORITY) & 1 ? " behind BG" : ""
+        );
+    }
+
+    ImGui::EndTable();
+    ImGui::End();
+}
+
+const char *Sprites::title() const {
+    return "Sprites";
+}
+
+// A tall sprite is two tiles, the first one with the lowest bit cleared
+void Sprites::render_sprite(Emulator::GameBoy *gb, const uint8_t index, const bool is_tall) {
+
+    const auto *const entry = &gb->mmu.oam[index * 4];
+    const auto number = entry[2];
+    const auto attributes = entry[3];
+
+    const bool is_flipped_x = (attributes >> SPRITE_ATTR_FLIP_X) & 1;
+    const bool is_flipped_y = (attributes >> SPRITE_ATTR_FLIP_Y) & 1;
+
+    uint8_t bank = 0;
+    TileCache::Palette palette;
+
+    if(gb->cart.is_colour) {
+        bank = (attributes & TILE_ATTR_BANK) ? 1 : 0;
+        palette = TileCache::obj_palette(gb, attributes & TILE_ATTR_PALETTE);
+    }
+    else
+        palette = TileCache::obj_palette(gb, (attributes >> SPRITE_ATTR_PALETTE) & 1);
+
+    const auto texture = debugger().tiles().texture(gb, palette);
+    const auto size = ImVec2(TILE_WIDTH * SCALE, TILE_WIDTH * SCALE);
+
+    if(!is_tall) {
+        const auto [uv_start, uv_end] = TileCache::uv(bank, number, is_flipped_x, is_flipped_y);
+        ImGui::Image(texture, size, uv_start, uv_end);
+        return;
+    }
+
+    // Flipping a tall sprite vertically also swaps its tiles
+    const uint8_t top = is_flipped_y ? number | 1 : number & 0xFE;
+    const uint8_t bottom = is_flipped_y ? number & 0xFE : number | 1;
+
+    ImGui::BeginGroup();
+    ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0.0f, 0.0f));
+
+    for(const auto tile : { top, bottom }) {
+        const auto [uv_start, uv_end] = TileCache::uv(bank, tile, is_flipped_x, is_flipped_y);
+        ImGui::Image(texture, size, uv_start, uv_end);
+    }
+
+    ImGui::PopStyleVar();
+    ImGui::EndGroup();
+}
+
+// Outline of every sprite over the screen area, the hovered one is filled
+void Sprites::render_screen(Emulator::GameBoy *gb, const bool is_tall) {
+
+    const auto origin = ImGui::GetCursorScreenPos();
+    const auto scale = 2.0f;
+    const auto height = is_tall ? 16 : 8;
+
+    // The sprite coordinates start 8 pixels left and 16 pixels above the screen
+    const auto area = ImVec2((SCREEN_WIDTH + 16) * scale, (SCREEN_HEIGHT + 32) * scale);
+    ImGui::InvisibleButton("##screen", area);
+
+    const auto is_hovered = ImGui::IsItemHovered();
+    const auto mouse = ImGui::GetMousePos();
+
+    auto *const draw_list = ImGui::GetWindowDrawList();
+    draw_list->AddRectFilled(origin, ImVec2(origin.x + area.x, origin.y + area.y), IM_COL32(40, 40, 40, 255));
+    draw_list->AddRectFilled(
+        ImVec2(origin.x + 8 * scale, origin.y + 16 * scale),
+        ImVec2(origin.x + (SCREEN_WIDTH + 8) * scale, origin.y + (SCREEN_HEIGHT + 16) * scale),
+        IM_COL32(80, 80, 80, 255)
+    );
+
+    draw_list->PushClipRect(origin, ImVec2(origin.x + area.x, origin.y + area.y), true);
+
+    for(uint8_t i = 0; i < SPRITE_COUNT; ++i) {
+
+        const auto *const entry = &gb->mmu.oam[i * 4];
+        const auto start = ImVec2(origin.x + entry[1] * scale, origin.y + entry[0] * scale);
+        const auto end = ImVec2(start.x + 8 * scale, start.y + height * scale);
+
+        const auto is_under_mouse = is_hovered && mouse.x >= start.x && mouse.x < end.x && mouse.y >= start.y && mouse.y < end.y;
+
+        if(is_under_mouse) {
+            draw_list->AddRectFilled(start, end, IM_COL32(255, 255, 0, 120));
+            ImGui::SetTooltip("#%d: %04X, X %d, Y %d", i, OAM_START + i * 4, entry[1] - 8, entry[0] - 16);
+        }
+
+        draw_list->AddRect(start, end, IM_COL32(0, 255, 0, 255));
+    }
+
+    draw_list->PopClipRect();
+}
@@ -40,6 +40,17 @@ void Stack::render() {
             ImGui::TextColored(Colours::address, "0x%04X: ", addr);
             ImGui::SameLine();
             ImGui::Text("%02X", SREAD8(addr));
+
+            // Return addresses are shown with the symbol they point into
+            if(i % 2 == 0 && addr < 0xFFFF) {
+                const auto value = SREAD16(addr);
+                const auto bank = Emulator::mapped_bank(gb, value);
+
+                if(debugger().symbols().nearest(bank, value) != nullptr) {
+                    ImGui::SameLine();
+                    ImGui::TextColored(Colours::comment, "%04X [%s]", value, debugger().symbols().name(bank, value).c_str());
+                }
+            }
         }
     }
 
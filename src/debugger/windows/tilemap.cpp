@@ -0,0 +1,183 @@
+#include <imgui.h>
+#include <algorithm>
+#include "debugger/debugger.h"
+#include "debugger/colours.h"
+#include "debugger/windows/tilemap.h"
+
+using namespace Windows;
+
+Tilemap::Tilemap(Debugger &debugger) : Window(debugger) {
+    _map = BackgroundMap;
+    _is_grid_shown = false;
+    _is_viewport_shown = true;
+    _textures.fill(nullptr);
+}
+
+void Tilemap::render() {
+
+    if(!ImGui::Begin(title())) {
+        ImGui::End();
+        return;
+    }
+
+    INIT_GB_CTX();
+
+    ImGui::SetNextItemWidth(120.0f);
+    ImGui::Combo("Map", &_map, "Background\0Window\09800\09C00\0");
+    ImGui::SameLine();
+    ImGui::Checkbox("Grid", &_is_grid_shown);
+    ImGui::SameLine();
+    ImGui::Checkbox("Viewport", &_is_viewport_shown);
+
+    const auto window_size = ImGui::GetContentRegionAvail();
+    const auto scale = std::max(1.0f, std::min(window_size.x, window_size.y) / MAP_WIDTH);
+    const auto origin = ImGui::GetCursorScreenPos();
+
+    ImGui::InvisibleButton("##map", ImVec2(MAP_WIDTH * scale, MAP_WIDTH * scale));
+    const auto is_hovered = ImGui::IsItemHovered();
+
+    _textures.fill(nullptr);
+    render_map(gb, origin, scale);
+
+    if(_is_viewport_shown)
+        render_viewport(gb, origin, scale);
+
+    if(is_hovered)
+        render_tooltip(gb, origin, scale);
+
+    ImGui::End();
+}
+
+const char *Tilemap::title() const {
+    return "Tilemap";
+}
+
+uint16_t Tilemap::map_start(Emulator::GameBoy *gb) const {
+
+    switch(_map) {
+        case BackgroundMap: return RREG(LCDC, LCDC_BG_TILE_MAP) ? 0x9C00 : 0x9800;
+        case WindowMap: return RREG(LCDC, LCDC_WINDOW_TILE_MAP) ? 0x9C00 : 0x9800;
+        case Map9800: return 0x9800;
+        default: return 0x9C00;
+    }
+}
+
+// Only the palettes actually used by the map are brought up to date
+ImTextureID Tilemap::texture(Emulator::GameBoy *gb, const uint8_t palette) {
+
+    if(_textures[palette] == nullptr)
+        _textures[palette] = debugger().tiles().texture(gb, TileCache::bg_palette(gb, palette));
+
+    return _textures[palette];
+}
+
+void Tilemap::render_map(Emulator::GameBoy *gb, const ImVec2 origin, const float scale) {
+
+    auto *const draw_list = ImGui::GetWindowDrawList();
+    const auto start = map_start(gb) - VRAM_START;
+    const auto is_signed = !RREG(LCDC, LCDC_BG_WINDOW_TILE_DATA);
+    const auto tile_size = TILE_WIDTH * scale;
+
+    for(uint32_t y = 0; y < MAP_SIZE; ++y) {
+        for(uint32_t x = 0; x < MAP_SIZE; ++x) {
+
+            const auto offset = start + y * MAP_SIZE + x;
+            const auto number = gb->mmu.vram_banks[0][offset];
+            const uint16_t tile = is_signed ? 0x100 + static_cast<int8_t>(number) : number;
+
+            // The attributes are at the same place in the second bank (CGB)
+            const uint8_t attributes = gb->cart.is_colour ? gb->mmu.vram_banks[1][offset] : 0;
+            const uint8_t bank = (attributes & TILE_ATTR_BANK) ? 1 : 0;
+
+            const auto [uv_start, uv_end] = TileCache::uv(
+                bank,
+                tile,
+                attributes & TILE_ATTR_FLIP_X,
+                attributes & TILE_ATTR_FLIP_Y
+            );
+
+            const auto tile_start = ImVec2(origin.x + x * tile_size, origin.y + y * tile_size);
+            const auto tile_end = ImVec2(tile_start.x + tile_size, tile_start.y + tile_size);
+
+            draw_list->AddImage(texture(gb, attributes & TILE_ATTR_PALETTE), tile_start, tile_end, uv_start, uv_end);
+
+            if(_is_grid_shown)
+                draw_list->AddRect(tile_start, tile_end, IM_COL32(128, 128, 128, 80));
+        }
+    }
+}
+
+// Part of the map shown on the screen, the background wraps around
+void Tilemap::render_viewport(Emulator::GameBoy *gb, const ImVec2 origin, const float scale) const {
+
+    auto *const draw_list = ImGui::GetWindowDrawList();
+    const auto map_size = MAP_WIDTH * scale;
+    const auto colour = IM_COL32(255, 0, 0, 255);
+
+    draw_list->PushClipRect(origin, ImVec2(origin.x + map_size, origin.y + map_size), true);
+
+    if(_map == WindowMap) {
+        const auto width = std::max(0, SCREEN_WIDTH - (SREAD8(WX) - 7));
+        const auto height = std::max(0, SCREEN_HEIGHT - SREAD8(WY));
+
+        if(width > 0 && height > 0)
+            draw_list->AddRect(origin, ImVec2(origin.x + width * scale, origin.y + height * scale), colour, 0.0f, 0, 2.0f);
+    }
+    else {
+        const auto x = SREAD8(SCX) * scale;
+        const auto y = SREAD8(SCY) * scale;
+
+        for(const auto offset_x : { 0.0f, -map_size }) {
+            for(const auto offset_y : { 0.0f, -map_size }) {
+                const auto start = ImVec2(origin.x + x + offset_x, origin.y + y + offset_y);
+                const auto end = ImVec2(start.x + SCREEN_WIDTH * scale, start.y + SCREEN_HEIGHT * scale);
+
+                draw_list->AddRect(start, end, colour, 0.0f, 0, 2.0f);
+            }
+        }
+    }
+
+    draw_list->PopClipRect();
+}
+
+void Tilemap::render_tooltip(Emulator::GameBoy *gb, const ImVec2 origin, const float scale) {
+
+    const auto mouse = ImGui::GetMousePos();
+    const auto x = static_cast<uint32_t>((mouse.x - origin.x) / (TILE_WIDTH * scale));
+    const auto y = static_cast<uint32_t>((mouse.y - origin.y) / (TILE_WIDTH * scale));
+
+    if(x >= MAP_SIZE || y >= MAP_SIZE)
+        return;
+
+    const uint16_t map_address = map_start(gb) + y * MAP_SIZE + x;
+    const auto offset = map_address - VRAM_START;
+    const auto number = gb->mmu.vram_banks[0][offset];
+    const auto is_signed = !RREG(LCDC, LCDC_BG_WINDOW_TILE_DATA);
+    const uint16_t tile = is_signed ? 0x100 + static_cast<int8_t>(number) : number;
+    const uint8_t attributes = gb->cart.is_colour ? gb->mmu.vram_banks[1][offset] : 0;
+    const uint8_t bank = (attributes & TILE_ATTR_BANK) ? 1 : 0;
+
+    const auto [uv_start, uv_end] = TileCache::uv(bank, tile, attributes & TILE_ATTR_FLIP_X, attributes & TILE_ATTR_FLIP_Y);
+
+    ImGui::BeginTooltip();
+    ImGui::Image(texture(gb, attributes & TILE_ATTR_PALETTE), ImVec2(64.0f, 64.0f), uv_start, uv_end);
+    ImGui::SameLine();
+    ImGui::BeginGroup();
+    ImGui::Text("X %u, Y %u", x, y);
+    ImGui::TextColored(Colours::address, "Map %04X", map_address);
+    ImGui::Text("Tile %02X", number);
+    ImGui::TextColored(Colours::address, "Data %d:%04X", bank, VRAM_START + tile * VRAM_TILE_SIZE);
+
+    if(gb->cart.is_colour) {
+        ImGui::Text(
+            "Palette %d%s%s%s",
+            attributes & TILE_ATTR_PALETTE,
+            (attributes & TILE_ATTR_FLIP_X) ? ", flip X" : "",
+            (attributes & TILE_ATTR_FLIP_Y) ? ", flip Y" : "",
+            (attributes & TILE_ATTR_BG_PRIORITY) ? ", priority" : ""
+        );
+    }
+
+    ImGui::EndGroup();
+    ImGui::EndTooltip();
+}
@@ -0,0 +1,132 @@
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include "debugger/debugger.h"
+#include "debugger/colours.h"
+#include "debugger/windows/tiles.h"
+
+using namespace Windows;
+
+Tiles::Tiles(Debugger &debugger) : Window(debugger) {
+    _is_obj_palette = false;
+    _palette = 0;
+}
+
+void Tiles::render() {
+
+    if(!ImGui::Begin(title())) {
+        ImGui::End();
+        return;
+    }
+
+    INIT_GB_CTX();
+    render_palette_combo(gb);
+
+    const auto palette = _is_obj_palette
+        ? TileCache::obj_palette(gb, _palette)
+        : TileCache::bg_palette(gb, _palette);
+
+    const auto texture = debugger().tiles().texture(gb, palette);
+
+    const auto window_size = ImGui::GetContentRegionAvail();
+    const auto scale = std::max(1.0f, std::min(window_size.x / TileCache::WIDTH, window_size.y / TileCache::HEIGHT));
+    const auto origin = ImGui::GetCursorScreenPos();
+
+    ImGui::Image(texture, ImVec2(TileCache::WIDTH * scale, TileCache::HEIGHT * scale));
+
+    // The banks are side by side
+    auto *const draw_list = ImGui::GetWindowDrawList();
+    const auto bank_width = TileCache::WIDTH / VRAM_BANK_COUNT * scale;
+    draw_list->AddLine(
+        ImVec2(origin.x + bank_width, origin.y),
+        ImVec2(origin.x + bank_width, origin.y + TileCache::HEIGHT * scale),
+        IM_COL32(255, 0, 0, 255)
+    );
+
+    if(!ImGui::IsItemHovered()) {
+        ImGui::End();
+        return;
+    }
+
+    const auto mouse = ImGui::GetMousePos();
+    const auto x = static_cast<uint32_t>((mouse.x - origin.x) / scale) / TILE_WIDTH;
+    const auto y = static_cast<uint32_t>((mouse.y - origin.y) / scale) / TILE_WIDTH;
+
+    const uint8_t bank = x / TileCache::TILES_PER_ROW;
+    const uint16_t tile = y * TileCache::TILES_PER_ROW + x % TileCache::TILES_PER_ROW;
+
+    if(bank >= VRAM_BANK_COUNT || tile >= VRAM_TILE_COUNT) {
+        ImGui::End();
+        return;
+    }
+
+    const auto tile_size = TILE_WIDTH * scale;
+    const auto tile_start = ImVec2(origin.x + x * tile_size, origin.y + y * tile_size);
+    draw_list->AddRect(tile_start, ImVec2(tile_start.x + tile_size, tile_start.y + tile_size), IM_COL32(255, 255, 0, 255));
+
+    const auto [uv_start, uv_end] = TileCache::uv(bank, tile);
+    const uint16_t address = VRAM_START + tile * VRAM_TILE_SIZE;
+
+    ImGui::BeginTooltip();
+    ImGui::Image(texture, ImVec2(64.0f, 64.0f), uv_start, uv_end);
+    ImGui::SameLine();
+    ImGui::BeginGroup();
+    ImGui::TextColored(Colours::address, "%d:%04X", bank, address);
+
+    // Number of the tile in the maps and OAM for each addressing mode
+    if(tile < 0x100)
+        ImGui::Text("8000: %02X", tile);
+    if(tile >= 0x80)
+        ImGui::Text("8800: %02X", (tile - 0x100) & 0xFF);
+
+    ImGui::EndGroup();
+    ImGui::EndTooltip();
+
+    ImGui::End();
+}
+
+const char *Tiles::title() const {
+    return "Tiles";
+}
+
+void Tiles::render_palette_combo(Emulator::GameBoy *gb) {
+
+    const auto is_colour = gb->cart.is_colour;
+    const auto palette_count = is_colour ? PALETTE_COUNT : 1;
+    const auto obj_palette_count = is_colour ? PALETTE_COUNT : 2;
+
+    // The palettes of the other model don't exist
+    _palette = std::min<uint8_t>(_palette, (_is_obj_palette ? obj_palette_count : palette_count) - 1);
+
+    const auto name = [is_colour](const bool is_obj, const uint8_t palette) {
+        static char buffer[16];
+
+        if(is_colour)
+            snprintf(buffer, sizeof(buffer), "%s %d", is_obj ? "OBJ" : "BG", palette);
+        else
+            snprintf(buffer, sizeof(buffer), "%s", is_obj ? (palette == 0 ? "OBP0" : "OBP1") : "BGP");
+
+        return buffer;
+    };
+
+    ImGui::SetNextItemWidth(100.0f);
+
+    if(!ImGui::BeginCombo("Palette", name(_is_obj_palette, _palette)))
+        return;
+
+    for(uint8_t type = 0; type < 2; ++type) {
+        const auto is_obj = type == 1;
+
+        for(uint8_t palette = 0; palette < (is_obj ? obj_palette_count : palette_count); ++palette) {
+
+            const auto is_selected = is_obj == _is_obj_palette && palette == _palette;
+
+            if(ImGui::Selectable(name(is_obj, palette), is_selected)) {
+                _is_obj_palette = is_obj;
+                _palette = palette;
+            }
+        }
+    }
+
+    ImGui::EndCombo();
+}
@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <imgui.h>
+#include "debugger/debugger.h"
+#include "debugger/colours.h"
+#include "debugger/windows/timeline.h"
+
+using namespace Windows;
+
+Timeline::Timeline(Debugger &debugger) : Window(debugger) {
+    _is_shown.fill(true);
+    _is_shown[Emulator::EventModeChange] = false; // Already shown as the background of the raster
+    _selected = std::nullopt;
+    _should_scroll = false;
+}
+
+void Timeline::render() {
+
+    if(!ImGui::Begin(title())) {
+        ImGui::End();
+        return;
+    }
+
+    INIT_GB_CTX();
+    const auto &timeline = gb->timeline;
+
+    bool is_enabled = timeline.is_enabled;
+    if(ImGui::Checkbox("Record", &is_enabled)) {
+        debugger().edit([is_enabled](Emulator::GameBoy *gb) {
+            if(is_enabled)
+                Emulator::start_timeline(gb);
+            else
+                Emulator::stop_timeline(gb);
+        });
+    }
+
+    ImGui::SameLine();
+    ImGui::Text("%u events", timeline.frame_count);
+
+    if(timeline.frame_dropped > 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImColor(255, 80, 80), "(%u dropped)", timeline.frame_dropped);
+    }
+
+    for(uint8_t type = 0; type < EVENT_TYPE_COUNT; ++type) {
+        ImGui::SameLine();
+        ImGui::PushStyleColor(ImGuiCol_Text, type_colour(type));
+        ImGui::Checkbox(type_name(type), &_is_shown[type]);
+        ImGui::PopStyleColor();
+    }
+
+    if(timeline.frame == nullptr || timeline.frame_count == 0) {
+        ImGui::End();
+        return;
+    }
+
+    if(_selected.has_value() && *_selected >= timeline.frame_count)
+        _selected = std::nullopt;
+
+    _shown_events.clear();
+
+    for(uint32_t i = 0; i < timeline.frame_count; ++i)
+        if(_is_shown[timeline.frame[i].type])
+            _shown_events.push_back(i);
+
+    render_raster(timeline.frame, timeline.frame_count);
+    render_events(timeline.frame);
+    ImGui::End();
+}
+
+const char *Timeline::title() const {
+    return "Timeline";
+}
+
+// One row per line from the start of V-Blank, the background is the PPU mode
+void Timeline::render_raster(const Emulator::TimelineEvent *events, const uint32_t count) {
+
+    auto *const draw_list = ImGui::GetWindowDrawList();
+    const auto origin = ImGui::GetCursorScreenPos();
+    const auto x = origin.x + MARGIN;
+    const auto width = std::max(ImGui::GetContentRegionAvail().x - MARGIN, 1.0f);
+    const auto dot_width = width / CLOCKS_PER_SCANLINE;
+
+    // The mode before the first change is the one the frame started in
+    uint16_t mode = Emulator::VBlank;
+    uint32_t mode_start = 0;
+
+    for(uint32_t i = 0; i < count; ++i) {
+
+        if(events[i].type != Emulator::EventModeChange)
+            continue;
+
+        fill_span(mode_start, time_of(events[i]), mode_colour(mode), x, origin.y, dot_width);
+        mode = events[i].data;
+        mode_start = time_of(events[i]);
+    }
+
+    fill_span(mode_start, LINE_COUNT * CLOCKS_PER_SCANLINE, mode_colour(mode), x, origin.y, dot_width);
+
+    for(const auto line : { 0u, 48u, 96u, FIRST_LINE }) {
+        const auto row = (line + LINE_COUNT - FIRST_LINE) % LINE_COUNT;
+        char text[8];
+        snprintf(text, sizeof(text), "LY %u", line);
+        draw_list->AddText(ImVec2(origin.x, origin.y + row * LINE_HEIGHT), IM_COL32(200, 200, 200, 255), text);
+    }
+
+    for(const auto i : _shown_events) {
+
+        if(events[i].type == Emulator::EventModeChange)
+            continue;
+
+        const auto time = time_of(events[i]);
+        const auto marker_x = x + (time % CLOCKS_PER_SCANLINE) * dot_width;
+        const auto marker_y = origin.y + (time / CLOCKS_PER_SCANLINE) * LINE_HEIGHT;
+        const auto size = _selected == i ? 4.0f : 1.0f;
+
+        draw_list->AddRectFilled(
+            ImVec2(marker_x - size, marker_y - size),
+            ImVec2(marker_x + size + 1.0f, marker_y + LINE_HEIGHT + size),
+            type_colour(events[i].type)
+        );
+    }
+
+    const auto size = ImVec2(MARGIN + width, LINE_COUNT * LINE_HEIGHT);
+    ImGui::InvisibleButton("##raster", size);
+
+    if(!ImGui::IsItemHovered())
+        return;
+
+    // The closest shown event on the hovered line
+    const auto mouse = ImGui::GetMousePos();
+    const auto row = static_cast<int32_t>((mouse.y - origin.y) / LINE_HEIGHT);
+    const auto dot = static_cast<int32_t>((mouse.x - x) / dot_width);
+    std::optional<uint32_t> closest;
+    int32_t closest_distance = 8;
+
+    for(const auto i : _shown_events) {
+
+        const auto time = static_cast<int32_t>(time_of(events[i]));
+
+        if(time / CLOCKS_PER_SCANLINE != row)
+            continue;
+
+        const auto distance = std::abs(time % CLOCKS_PER_SCANLINE - dot);
+
+        if(distance <= closest_distance) {
+            closest = i;
+            closest_distance = distance;
+        }
+    }
+
+    if(!closest.has_value()) {
+        ImGui::SetTooltip("LY %u, dot %d", (row + FIRST_LINE) % LINE_COUNT, dot);
+        return;
+    }
+
+    const auto &event = events[*closest];
+    ImGui::SetTooltip(
+        "%s\nLY %u, dot %u\n%04X %s = %02X\nPC %04X",
+        type_name(event.type),
+        event.line,
+        event.dot,
+        event.address,
+        register_name(event.address),
+        event.data,
+        event.pc
+    );
+
+    if(ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+        _selected = closest;
+        _should_scroll = true;
+    }
+}
+
+void Timeline::render_events(const Emulator::TimelineEvent *events) {
+
+    static constexpr auto flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+        ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingFixedFit;
+
+    if(!ImGui::BeginTable("##events", 6, flags))
+        return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Line");
+    ImGui::TableSetupColumn("Dot");
+    ImGui::TableSetupColumn("Event");
+    ImGui::TableSetupColumn("Address");
+    ImGui::TableSetupColumn("Data");
+    ImGui::TableSetupColumn("PC", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    INIT_GB_CTX();
+    ImGuiListClipper clipper(static_cast<int>(_shown_events.size()));
+
+    while(clipper.Step()) {
+
+        if(_should_scroll && _selected.has_value()) {
+            const auto row = std::lower_bound(_shown_events.begin(), _shown_events.end(), *_selected) - _shown_events.begin();
+            ImGui::SetScrollY(ImGui::GetTextLineHeightWithSpacing() * static_cast<float>(row));
+            _should_scroll = false;
+        }
+
+        for(auto row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+
+            const auto i = _shown_events[row];
+            const auto &event = events[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+
+            ImGui::PushID(row);
+            if(ImGui::Selectable("", _selected == i, ImGuiSelectableFlags_SpanAllColumns))
+                _selected = i;
+
+            ImGui::PopID();
+            ImGui::SameLine();
+            ImGui::Text("%u", event.line);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", event.dot);
+            ImGui::TableNextColumn();
+            ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(type_colour(event.type)), "%s", type_name(event.type));
+            ImGui::TableNextColumn();
+            ImGui::TextColored(Colours::address, "%04X %s", event.address, register_name(event.address));
+            ImGui::TableNextColumn();
+            ImGui::Text("%02X", event.data);
+            ImGui::TableNextColumn();
+
+            const auto bank = Emulator::mapped_bank(gb, event.pc);
+            ImGui::Text("%04X %s", event.pc, debugger().symbols().name(bank, event.pc).c_str());
+        }
+    }
+
+    clipper.End();
+    ImGui::EndTable();
+}
+
+// Fills the rows between two times of the frame
+void Timeline::fill_span(uint32_t start, const uint32_t end, const uint32_t colour, const float x, const float y, const float dot_width) const {
+
+    auto *const draw_list = ImGui::GetWindowDrawList();
+
+    while(start < end) {
+        const auto row = start / CLOCKS_PER_SCANLINE;
+        const auto first_dot = start % CLOCKS_PER_SCANLINE;
+        const auto last_dot = std::min<uint32_t>(CLOCKS_PER_SCANLINE, first_dot + end - start);
+
+        draw_list->AddRectFilled(
+            ImVec2(x + first_dot * dot_width, y + row * LINE_HEIGHT),
+            ImVec2(x + last_dot * dot_width, y + (row + 1) * LINE_HEIGHT),
+            colour
+        );
+
+        start += last_dot - first_dot;
+    }
+}
+
+// T-cycles since the start of the frame
+uint32_t Timeline::time_of(const Emulator::TimelineEvent &event) {
+    const auto row = (event.line + LINE_COUNT - FIRST_LINE) % LINE_COUNT;
+    return row * CLOCKS_PER_SCANLINE + std::min<uint32_t>(event.dot, CLOCKS_PER_SCANLINE - 1);
+}
+
+const char *Timeline::type_name(const uint8_t type) {
+
+    static const char *names[EVENT_TYPE_COUNT] = {
+        "Mode", "Interrupt", "Timer", "DMA", "HDMA", "Write"
+    };
+
+    return type < EVENT_TYPE_COUNT ? names[type] : "?";
+}
+
+uint32_t Timeline::type_colour(const uint8_t type) {
+
+    static const uint32_t colours[EVENT_TYPE_COUNT] = {
+        IM_COL32(200, 200, 200, 255),
+        IM_COL32(255, 60, 60, 255),
+        IM_COL32(255, 220, 40, 255),
+        IM_COL32(40, 220, 255, 255),
+        IM_COL32(80, 140, 255, 255),
+        IM_COL32(255, 255, 255, 255)
+    };
+
+    return type < EVENT_TYPE_COUNT ? colours[type] : IM_COL32(255, 0, 255, 255);
+}
+
+uint32_t Timeline::mode_colour(const uint16_t mode) {
+
+    switch(mode) {
+        case Emulator::HBlank: return IM_COL32(30, 50, 30, 255);
+        case Emulator::VBlank: return IM_COL32(40, 30, 60, 255);
+        case Emulator::OamTransfer: return IM_COL32(70, 60, 30, 255);
+        default: return IM_COL32(30, 60, 80, 255);
+    }
+}
+
+const char *Timeline::register_name(const uint16_t address) {
+
+    if(address >= NR10 && address <= NR52)
+        return "APU";
+
+    switch(address) {
+        case JOYP: return "JOYP";
+        case SB: return "SB";
+        case DIV: return "DIV";
+        case TIMA: return "TIMA";
+        case TMA: return "TMA";
+        case TAC: return "TAC";
+        case IF: return "IF";
+        case LCDC: return "LCDC";
+        case STAT: return "STAT";
+        case SCY: return "SCY";
+        case SCX: return "SCX";
+        case LY: return "LY";
+        case LYC: return "LYC";
+        case DMA: return "DMA";
+        case BGP: return "BGP";
+        case OBP0: return "OBP0";
+        case OBP1: return "OBP1";
+        case WY: return "WY";
+        case WX: return "WX";
+        case KEY1: return "KEY1";
+        case VBK: return "VBK";
+        case HDMA1: return "HDMA1";
+        case HDMA2: return "HDMA2";
+        case HDMA3: return "HDMA3";
+        case HDMA4: return "HDMA4";
+        case HDMA5: return "HDMA5";
+        case BGPI: return "BGPI";
+        case BGPD: return "BGPD";
+        case OBPI: return "OBPI";
+        case OBPD: return "OBPD";
+        case SVBK: return "SVBK";
+        case IE: return "IE";
+        default: return "";
+    }
+}
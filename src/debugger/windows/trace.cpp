@@ -0,0 +1,335 @@
+#include <imgui.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include "debugger/debugger.h"
+#include "debugger/colours.h"
+#include "debugger/windows/trace.h"
+
+using namespace Windows;
+
+
+Trace::Trace(Debugger &debugger) : Window(debugger) {
+    _is_pending_ready = false;
+    _is_requested = false;
+    _stop_count = 0;
+    _was_paused = true;
+
+    _selected = std::nullopt;
+    _should_scroll = false;
+
+    _search_mode = SearchMode::Address;
+    _search.fill('\0');
+    _trace_path.fill('\0');
+    std::strcpy(_trace_path.data(), "trace.bin");
+    _doctor_path.fill('\0');
+    std::strcpy(_doctor_path.data(), "doctor.log");
+}
+
+void Trace::render() {
+
+    if(!ImGui::Begin(title())) {
+        ImGui::End();
+        return;
+    }
+
+    auto &state = debugger().state();
+    auto *const gb = state.gb();
+
+    // The recorded instructions are fetched again every time the emulator stops
+    if(state.is_paused && gb->trace.chunks != nullptr && (!_was_paused || state.stop_count != _stop_count))
+        request_records();
+
+    _was_paused = state.is_paused;
+    _stop_count = state.stop_count;
+    take_records();
+
+    bool is_recording = gb->trace.is_recording;
+    if(ImGui::Checkbox("Record", &is_recording)) {
+        debugger().edit([is_recording](Emulator::GameBoy *gb) {
+            if(is_recording)
+                Emulator::start_trace(gb, nullptr);
+            else
+                Emulator::stop_trace(gb);
+        });
+    }
+
+    ImGui::SameLine();
+
+    if(ImGui::Button("Refresh") && gb->trace.chunks != nullptr)
+        request_records();
+
+    ImGui::SameLine();
+    ImGui::Text("%zu instructions", _records.size());
+
+    // Addresses are [bank:]address in hex, instructions are searched in the disassembly
+    if(ImGui::RadioButton("Address", _search_mode == SearchMode::Address))
+        _search_mode = SearchMode::Address;
+
+    ImGui::SameLine();
+
+    if(ImGui::RadioButton("Instruction", _search_mode == SearchMode::Instruction))
+        _search_mode = SearchMode::Instruction;
+
+    ImGui::SameLine();
+
+    if(ImGui::InputText("##search", _search.data(), _search.size(), ImGuiInputTextFlags_EnterReturnsTrue))
+        find_next();
+
+    ImGui::SameLine();
+
+    if(ImGui::Button("Find next"))
+        find_next();
+
+    // Separate files, exporting the log never overwrites the trace it was loaded from
+    ImGui::InputText("##trace_path", _trace_path.data(), _trace_path.size());
+    ImGui::SameLine();
+
+    if(ImGui::Button("Load trace"))
+        load(_trace_path.data());
+
+    ImGui::InputText("##doctor_path", _doctor_path.data(), _doctor_path.size());
+    ImGui::SameLine();
+
+    if(ImGui::Button("Export Gameboy Doctor log"))
+        export_doctor(_doctor_path.data());
+
+    if(!_status.empty()) {
+        ImGui::SameLine();
+        ImGui::Text("%s", _status.c_str());
+    }
+
+    ImGui::Separator();
+    render_records();
+    ImGui::End();
+}
+
+const char *Trace::title() const {
+    return "Trace";
+}
+
+void Trace::render_records() {
+
+    ImGui::BeginChild("##scroll");
+    ImGuiListClipper clipper(static_cast<int>(_records.size()));
+
+    while(clipper.Step()) {
+
+        if(_should_scroll && _selected.has_value()) {
+            const auto offset = ImGui::GetTextLineHeightWithSpacing() * static_cast<float>(*_selected);
+            ImGui::SetScrollFromPosY(ImGui::GetCursorStartPos().y + offset);
+            _should_scroll = false;
+        }
+
+        for(auto i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+
+            char line[224];
+            format_record(_records[i], line, sizeof(line));
+
+            ImGui::PushID(i);
+            if(ImGui::Selectable(line, _selected == static_cast<size_t>(i)))
+                _selected = i;
+
+            ImGui::PopID();
+        }
+    }
+
+    clipper.End();
+    ImGui::EndChild();
+}
+
+// Decodes the ring on the core thread, it doesn't change while the request is applied
+void Trace::request_records() {
+
+    if(_is_requested)
+        return;
+
+    _is_requested = true;
+
+    debugger().edit([this](Emulator::GameBoy *gb) {
+        _pending.clear();
+
+        for(uint32_t i = 0; i < Emulator::trace_chunk_count(gb); ++i) {
+            const auto *const chunk = Emulator::trace_chunk(gb, i);
+            const auto offset = _pending.size();
+
+            _pending.resize(offset + chunk->count);
+            _pending.resize(offset + Emulator::decode_trace_chunk(chunk, _pending.data() + offset));
+        }
+
+        _is_pending_ready.store(true, std::memory_order_release);
+    });
+}
+
+void Trace::take_records() {
+
+    if(!_is_pending_ready.load(std::memory_order_acquire))
+        return;
+
+    _records.swap(_pending);
+    _is_pending_ready = false;
+    _is_requested = false;
+
+    // Show the last instruction executed
+    _selected = _records.empty() ? std::nullopt : std::optional<size_t>(_records.size() - 1);
+    _should_scroll = true;
+    _status.clear();
+}
+
+void Trace::find_next() {
+
+    if(_records.empty())
+        return;
+
+    std::optional<uint16_t> bank, addr;
+    std::string text(_search.data());
+
+    if(_search_mode == SearchMode::Address) {
+        const auto &symbols = debugger().symbols().all();
+        const auto symbol = std::find_if(symbols.begin(), symbols.end(), [&text](const auto &s) { return s.name == text; });
+
+        uint16_t first, second;
+        const auto count = sscanf(_search.data(), "%hx:%hx", &first, &second);
+
+        // A symbol name is also an address
+        if(symbol != symbols.end()) {
+            bank = symbol->bank;
+            addr = symbol->address;
+        }
+        else if(count == 2) {
+            bank = first;
+            addr = second;
+        }
+        else if(count == 1)
+            addr = first;
+        else {
+            _status = "Invalid address";
+            return;
+        }
+    }
+    else
+        std::transform(text.begin(), text.end(), text.begin(), [](const char c) { return static_cast<char>(std::toupper(c)); });
+
+    const auto start = _selected.has_value() ? *_selected + 1 : 0;
+
+    for(size_t n = 0; n < _records.size(); ++n) {
+
+        const auto i = (start + n) % _records.size();
+        const auto &record = _records[i];
+        bool is_match;
+
+        if(_search_mode == SearchMode::Address)
+            is_match = record.pc == *addr && (!bank.has_value() || record.bank == *bank);
+        else {
+            char instr[32];
+            format_instr(record, instr, sizeof(instr));
+
+            for(auto *c = instr; *c != '\0'; ++c)
+                *c = static_cast<char>(std::toupper(*c));
+
+            is_match = std::strstr(instr, text.c_str()) != nullptr;
+        }
+
+        if(is_match) {
+            _selected = i;
+            _should_scroll = true;
+            _status.clear();
+            return;
+        }
+    }
+
+    _status = "Not found";
+}
+
+// Reads a trace recorded with jgbc --trace
+void Trace::load(const char *path) {
+
+    auto *const file = std::fopen(path, "rb");
+
+    if(file == nullptr) {
+        _status = "Cannot open file";
+        return;
+    }
+
+    std::vector<uint8_t> data(TRACE_CHUNK_SIZE);
+    Emulator::TraceChunk chunk {};
+    chunk.data = data.data();
+
+    _records.clear();
+    bool is_corrupt = false;
+
+    while(!is_corrupt && Emulator::read_trace_chunk(file, &chunk)) {
+        const auto offset = _records.size();
+        _records.resize(offset + chunk.count);
+
+        const auto count = Emulator::decode_trace_chunk(&chunk, _records.data() + offset);
+        is_corrupt = count < chunk.count;
+        _records.resize(offset + count);
+    }
+
+    std::fclose(file);
+
+    _selected = _records.empty() ? std::nullopt : std::optional<size_t>(0);
+    _should_scroll = true;
+    _status = (is_corrupt ? "Corrupt trace, loaded " : "Loaded ") + std::to_string(_records.size()) + " instructions";
+}
+
+// One line per instruction, can be compared with the logs of other emulators
+void Trace::export_doctor(const char *path) {
+
+    auto *const file = std::fopen(path, "w");
+
+    if(file == nullptr) {
+        _status = "Cannot open file";
+        return;
+    }
+
+    char line[TRACE_DOCTOR_LINE_SIZE];
+
+    for(const auto &record : _records) {
+        Emulator::format_doctor_line(&record, line);
+        std::fprintf(file, "%s\n", line);
+    }
+
+    std::fclose(file);
+    _status = "Exported " + std::to_string(_records.size()) + " lines";
+}
+
+void Trace::format_record(const Emulator::TraceRecord &record, char *line, const size_t size) const {
+
+    char instr[32];
+    format_instr(record, instr, sizeof(instr));
+
+    const auto &symbols = debugger().symbols();
+    const auto symbol = symbols.nearest(record.bank, record.pc) != nullptr ? symbols.name(record.bank, record.pc) : "";
+
+    snprintf(
+        line,
+        size,
+        "%12llu  %02X:%04X  %-16s AF:%04X BC:%04X DE:%04X HL:%04X SP:%04X  %s",
+        static_cast<unsigned long long>(record.clock),
+        record.bank,
+        record.pc,
+        instr,
+        record.af,
+        record.bc,
+        record.de,
+        record.hl,
+        record.sp,
+        symbol.c_str()
+    );
+}
+
+void Trace::format_instr(const Emulator::TraceRecord &record, char *text, const size_t size) {
+
+    const auto instr = Emulator::decode_instr(record.memory);
+    uint16_t operand = 0;
+
+    if(instr.length == 2 && record.memory[0] != 0xCB)
+        operand = record.memory[1];
+    else if(instr.length == 3)
+        operand = record.memory[1] | record.memory[2] << 8;
+
+    snprintf(text, size, instr.disassembly, operand);
+}
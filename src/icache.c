@@ -0,0 +1,165 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "jgbc.h"
+#include "macro.h"
+#include "mmu.h"
+#include "cpu.h"
+#include "icache.h"
+
+static DecodedInstr *find_entry(GameBoy *, uint16_t, uint16_t *);
+static void read_instr(GameBoy *, uint16_t, DecodedInstr *);
+static void decode(const uint8_t *, DecodedInstr *);
+
+
+void init_icache(GameBoy *gb) {
+    gb->icache.is_enabled = true;
+    gb->icache.rom_banks = NULL;
+
+    gb->icache.wram_banks = malloc(sizeof(DecodedInstr *) * WRAM_BANK_COUNT);
+    for(uint8_t i = 0; i < WRAM_BANK_COUNT; ++i)
+        gb->icache.wram_banks[i] = calloc(WRAM_BANK_SIZE, sizeof(DecodedInstr));
+
+    gb->icache.hram = calloc(HRAM_SIZE, sizeof(DecodedInstr));
+}
+
+// Decodes the instruction at an address, or returns it as it was decoded the last time it ran
+// The entry is only valid until the next instruction is fetched
+const DecodedInstr *fetch_instr(GameBoy *gb, const uint16_t address) {
+
+    uint16_t size;
+    DecodedInstr *entry = gb->icache.is_enabled ? find_entry(gb, address, &size) : NULL;
+
+    if(entry == NULL) {
+        read_instr(gb, address, &gb->icache.uncached);
+        return &gb->icache.uncached;
+    }
+
+    if(entry->execute != NULL)
+        return entry;
+
+    read_instr(gb, address, entry);
+
+    // An instruction that runs over the end of its bank may be followed by another bank
+    if(size < entry->length) {
+        gb->icache.uncached = *entry;
+        entry->execute = NULL;
+
+        return &gb->icache.uncached;
+    }
+
+    return entry;
+}
+
+// Decodes the instruction at an address as if its opcode was followed by itself (HALT bug)
+// The PC is only incremented past the second copy
+const DecodedInstr *decode_repeated(GameBoy *gb, const uint16_t address) {
+
+    const uint8_t bytes[3] = { SREAD8(address), SREAD8(address), SREAD8(address + 1) };
+    DecodedInstr *entry = &gb->icache.uncached;
+
+    decode(bytes, entry);
+    entry->length--;
+
+    return entry;
+}
+
+// Called on every write to memory code can be cached from
+// The instructions that can cover the byte are decoded again the next time they run
+void invalidate_instr(GameBoy *gb, uint16_t address) {
+
+    // The debugger's snapshots have no cache
+    if(gb->icache.hram == NULL)
+        return;
+
+    // The echo of the work RAM changes the same bytes
+    if(address >= WRAM00_MIRROR_START && address <= WRAMNN_MIRROR_END)
+        address -= WRAM00_MIRROR_START - WRAM00_START;
+
+    for(uint8_t i = 0; i < 3; ++i) {
+
+        uint16_t size;
+        DecodedInstr *entry = find_entry(gb, address - i, &size);
+
+        if(entry != NULL)
+            entry->execute = NULL;
+    }
+}
+
+// Entry of the bank mapped at an address and the number of bytes left in the bank, NULL if it can't be cached
+static DecodedInstr *find_entry(GameBoy *gb, const uint16_t address, uint16_t *size) {
+
+    // 16KB ROM Bank 00 and NN
+    if(address <= ROMNN_END) {
+
+        if(gb->icache.rom_banks == NULL)
+            gb->icache.rom_banks = calloc(gb->cart.rom_size, sizeof(DecodedInstr *));
+
+        const uint16_t bank = address <= ROM00_END ? gb->mmu.rom00_bank : gb->mmu.rom_bank;
+        const uint16_t offset = address & (ROM_BANK_SIZE - 1);
+
+        if(gb->icache.rom_banks[bank] == NULL)
+            gb->icache.rom_banks[bank] = calloc(ROM_BANK_SIZE, sizeof(DecodedInstr));
+
+        *size = ROM_BANK_SIZE - offset;
+        return &gb->icache.rom_banks[bank][offset];
+    }
+    // 4KB Work RAM Bank 00 and NN
+    else if(address >= WRAM00_START && address <= WRAMNN_END) {
+
+        const uint8_t bank = address <= WRAM00_END ? 0 : gb->mmu.wram_bank;
+        const uint16_t offset = address & (WRAM_BANK_SIZE - 1);
+
+        *size = WRAM_BANK_SIZE - offset;
+        return &gb->icache.wram_banks[bank][offset];
+    }
+    // 127B High RAM, the interrupt enable register follows
+    else if(address >= HRAM_START && address <= HRAM_END) {
+
+        const uint16_t offset = address - HRAM_START;
+
+        *size = HRAM_END - address + 1;
+        return &gb->icache.hram[offset];
+    }
+
+    return NULL;
+}
+
+static void read_instr(GameBoy *gb, const uint16_t address, DecodedInstr *entry) {
+    const uint8_t bytes[3] = { SREAD8(address), SREAD8(address + 1), SREAD8(address + 2) };
+    decode(bytes, entry);
+}
+
+static void decode(const uint8_t *bytes, DecodedInstr *entry) {
+
+    const Instruction instruction = decode_instr(bytes);
+
+    entry->execute = instruction.execute;
+    entry->length = instruction.length;
+    entry->operand_length = instruction.length - 1;
+    entry->ticks = 0;
+
+    if(instruction.extended) {
+        entry->operand_length--;
+        entry->ticks += CPU_STEP;
+    }
+
+    entry->ticks += CPU_STEP * entry->operand_length;
+
+    switch(entry->operand_length) {
+
+        case 0:
+            entry->operand = 0;
+            break;
+
+        case 1:
+            entry->operand = bytes[1];
+            break;
+
+        case 2:
+            entry->operand = bytes[2] << 8 | bytes[1];
+            break;
+
+        default:
+            ASSERT_NOT_REACHED();
+    }
+}
@@ -0,0 +1,306 @@
+#include "jgbc.h"
+#include "mmu.h"
+#include "cpu.h"
+#include "ppu.h"
+#include "idle.h"
+
+static void begin_loop(GameBoy *, uint16_t, uint16_t);
+static void end_iteration(GameBoy *);
+static bool is_pure_loop(GameBoy *, uint16_t, uint16_t, uint16_t *);
+static bool is_idle_read(uint16_t);
+static bool is_same_state(const Registers *, const Registers *);
+static uint16_t next_idle_event(GameBoy *);
+
+
+void init_idle_loop(GameBoy *gb) {
+    gb->idle.is_enabled = true;
+    reset_idle_loop(gb);
+}
+
+void reset_idle_loop(GameBoy *gb) {
+    gb->idle.start = 0;
+    gb->idle.end = 0;
+    gb->idle.is_pure = false;
+}
+
+// Called after each instruction with its address
+// A pure loop that ends an iteration in the same state it started is repeated until the values it reads change
+// They only change with the timer or the PPU, so the iterations before their next event are skipped at once
+void update_idle_loop(GameBoy *gb, const uint16_t address) {
+
+    IdleLoop *idle = &gb->idle;
+    const uint16_t pc = REG(PC);
+
+    if(address >= idle->start && address < idle->end) {
+
+        if(!idle->is_pure)
+            return;
+
+        idle->ticks += gb->cpu.ticks;
+
+        if(pc == idle->start)
+            end_iteration(gb);
+
+        return;
+    }
+
+    // Left the loop, by an exit or an interrupt
+    if(idle->end != 0)
+        reset_idle_loop(gb);
+
+    // A taken branch backwards may close a loop
+    if(pc <= address && address - pc < IDLE_LOOP_MAX_SIZE)
+        begin_loop(gb, pc, address);
+}
+
+static void begin_loop(GameBoy *gb, const uint16_t start, const uint16_t branch) {
+
+    IdleLoop *idle = &gb->idle;
+
+    idle->start = start;
+    idle->is_pure = is_pure_loop(gb, start, branch, &idle->end);
+
+    if(!idle->is_pure)
+        return;
+
+    idle->registers = gb->cpu.reg;
+    idle->ticks = 0;
+    idle->quiet_ticks = next_idle_event(gb) - gb->cpu.ticks;
+}
+
+// The branch back to the start ends the iteration, the subsystems haven't seen its ticks yet
+static void end_iteration(GameBoy *gb) {
+
+    IdleLoop *idle = &gb->idle;
+    const uint16_t ticks = idle->ticks;
+    const bool is_quiet = ticks < idle->quiet_ticks;
+    const int32_t event_ticks = next_idle_event(gb) - gb->cpu.ticks;
+
+    idle->ticks = 0;
+    idle->quiet_ticks = event_ticks;
+
+    // Every instruction is recorded or watched
+    if(gb->trace.is_recording || gb->profiler.is_enabled || gb->mmu.watch.is_armed)
+        return;
+
+    // The next iterations read what this one read and end in the same state
+    if(!is_quiet || !is_same_state(&idle->registers, &gb->cpu.reg)) {
+        idle->registers = gb->cpu.reg;
+        return;
+    }
+
+    // Whole iterations that end before the next event
+    const int32_t count = (event_ticks - 1) / ticks;
+
+    if(count <= 0)
+        return;
+
+    gb->cpu.ticks += count * ticks;
+    idle->quiet_ticks -= count * ticks;
+}
+
+// Decodes the loop from its start to the branch that closed it
+// Each instruction only works on registers or reads memory that stays the same while nothing else runs
+// The registers used as an address are never written in the loop, so their value at the start is used
+static bool is_pure_loop(GameBoy *gb, const uint16_t start, const uint16_t branch, uint16_t *end) {
+
+    uint8_t written = 0;
+    uint8_t addressed = 0;
+
+    *end = branch + find_instr(gb, branch).length;
+    uint16_t address = start;
+
+    while(address <= branch) {
+
+        const uint8_t opcode = SREAD8(address);
+        const uint8_t length = find_instr(gb, address).length;
+        const uint8_t dest = (opcode >> 3) & 0x7;
+        const uint8_t src = opcode & 0x7;
+
+        int32_t target = -1;
+        uint16_t read = 0;
+        bool is_read = false;
+
+        switch(opcode) {
+
+            case 0x00:
+                break;
+
+            // Rotates and flag operations on A
+            case 0x07: case 0x0F: case 0x17: case 0x1F: case 0x27: case 0x2F: case 0x37: case 0x3F:
+                written |= IDLE_REG_A;
+                break;
+
+            // LD rr,nn INC rr DEC rr
+            case 0x01: case 0x03: case 0x0B: written |= IDLE_REG_BC; break;
+            case 0x11: case 0x13: case 0x1B: written |= IDLE_REG_DE; break;
+            case 0x21: case 0x23: case 0x2B: written |= IDLE_REG_HL; break;
+            case 0x31: case 0x33: case 0x3B: written |= IDLE_REG_SP; break;
+
+            // ADD HL,rr
+            case 0x09: case 0x19: case 0x29: case 0x39:
+                written |= IDLE_REG_HL;
+                break;
+
+            // LD A,(BC) LD A,(DE) LD A,(C)
+            case 0x0A:
+                is_read = true;
+                read = REG(BC);
+                addressed |= IDLE_REG_BC;
+                written |= IDLE_REG_A;
+                break;
+
+            case 0x1A:
+                is_read = true;
+                read = REG(DE);
+                addressed |= IDLE_REG_DE;
+                written |= IDLE_REG_A;
+                break;
+
+            case 0xF2:
+                is_read = true;
+                read = IO_START + REG(C);
+                addressed |= IDLE_REG_C;
+                written |= IDLE_REG_A;
+                break;
+
+            // LDH A,(n) LD A,(nn)
+            case 0xF0:
+                is_read = true;
+                read = IO_START + SREAD8(address + 1);
+                written |= IDLE_REG_A;
+                break;
+
+            case 0xFA:
+                is_read = true;
+                read = SREAD16(address + 1);
+                written |= IDLE_REG_A;
+                break;
+
+            // ALU A,n
+            case 0xC6: case 0xCE: case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+                written |= IDLE_REG_A;
+                break;
+
+            // JR e JR cc,e
+            case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+                target = (uint16_t) (address + length + (int8_t) SREAD8(address + 1));
+                break;
+
+            // JP nn JP cc,nn
+            case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+                target = SREAD16(address + 1);
+                break;
+
+            case 0xCB: {
+                const uint8_t cb_opcode = SREAD8(address + 1);
+                const uint8_t reg = cb_opcode & 0x7;
+
+                // BIT b,r only reads
+                if((cb_opcode & 0xC0) == 0x40) {
+                    if(reg == 6) {
+                        is_read = true;
+                        read = REG(HL);
+                        addressed |= IDLE_REG_HL;
+                    }
+                }
+                else if(reg == 6)
+                    return false;
+                else
+                    written |= 1 << reg;
+
+                break;
+            }
+
+            default:
+
+                // LD r,n INC r DEC r
+                if((opcode & 0xC7) == 0x06 || (opcode & 0xC7) == 0x04 || (opcode & 0xC7) == 0x05) {
+                    if(dest == 6)
+                        return false;
+
+                    written |= 1 << dest;
+                }
+                // LD r,r' except HALT and the stores to (HL)
+                else if(opcode >= 0x40 && opcode <= 0x7F) {
+                    if(dest == 6)
+                        return false;
+
+                    if(src == 6) {
+                        is_read = true;
+                        read = REG(HL);
+                        addressed |= IDLE_REG_HL;
+                    }
+
+                    written |= 1 << dest;
+                }
+                // ALU A,r
+                else if(opcode >= 0x80 && opcode <= 0xBF) {
+                    if(src == 6) {
+                        is_read = true;
+                        read = REG(HL);
+                        addressed |= IDLE_REG_HL;
+                    }
+
+                    written |= IDLE_REG_A;
+                }
+                else
+                    return false;
+        }
+
+        if(is_read && !is_idle_read(read))
+            return false;
+
+        // A branch either leaves the loop or starts the next iteration
+        if(target != -1 && target != start && target >= start && target < *end)
+            return false;
+
+        address += length;
+    }
+
+    // The instructions don't line up with the branch
+    return address == *end && !(written & addressed);
+}
+
+// Memory only the program changes, or the timer and PPU registers polled while waiting
+// The joypad, the other timer and sound registers and the cartridge RAM (clock) change on their own
+static bool is_idle_read(const uint16_t address) {
+
+    if(address <= VRAM_END)
+        return true;
+
+    if(address >= WRAM00_START && address <= OAM_END)
+        return true;
+
+    if(address >= HRAM_START)
+        return true;
+
+    switch(address) {
+        case DIV:
+        case IF:
+        case LCDC:
+        case STAT:
+        case SCY:
+        case SCX:
+        case LY:
+        case LYC:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// The loop may be polling DIV, unlike a halted CPU it sees every change
+static uint16_t next_idle_event(GameBoy *gb) {
+
+    const uint16_t event_ticks = next_event(gb);
+    const uint16_t divider_ticks = next_divider_event(gb);
+
+    return event_ticks < divider_ticks ? event_ticks : divider_ticks;
+}
+
+// The PC is the start of the loop for both and the loop never changes IME
+static bool is_same_state(const Registers *a, const Registers *b) {
+    return a->AF == b->AF && a->BC == b->BC && a->DE == b->DE && a->HL == b->HL && a->SP == b->SP;
+}
@@ -4,61 +4,46 @@
 
 
 void reset_input(GameBoy *gb) {
-    gb->input.up = false;
-    gb->input.right = false;
-    gb->input.down = false;
-    gb->input.left = false;
-    gb->input.start = false;
-    gb->input.select = false;
-    gb->input.a = false;
-    gb->input.b = false;
+    SDL_AtomicSet(&gb->input.keys, 0);
 }
 
 void set_key(GameBoy *gb, const SDL_Scancode code, const bool is_pressed) {
 
-    switch(code) {
-        case SDL_SCANCODE_RETURN:
-            gb->input.start = is_pressed; break;
-
-        case SDL_SCANCODE_BACKSPACE:
-            gb->input.select = is_pressed; break;
-
-        case SDL_SCANCODE_A:
-            gb->input.a = is_pressed; break;
-
-        case SDL_SCANCODE_S:
-            gb->input.b = is_pressed; break;
-
-        case SDL_SCANCODE_UP:
-            gb->input.up = is_pressed; break;
+    int key;
 
-        case SDL_SCANCODE_RIGHT:
-            gb->input.right = is_pressed; break;
-
-        case SDL_SCANCODE_DOWN:
-            gb->input.down = is_pressed; break;
+    switch(code) {
+        case SDL_SCANCODE_RETURN: key = INPUT_START; break;
+        case SDL_SCANCODE_BACKSPACE: key = INPUT_SELECT; break;
+        case SDL_SCANCODE_A: key = INPUT_A; break;
+        case SDL_SCANCODE_S: key = INPUT_B; break;
+        case SDL_SCANCODE_UP: key = INPUT_UP; break;
+        case SDL_SCANCODE_RIGHT: key = INPUT_RIGHT; break;
+        case SDL_SCANCODE_DOWN: key = INPUT_DOWN; break;
+        case SDL_SCANCODE_LEFT: key = INPUT_LEFT; break;
+        default: return;
+    }
 
-        case SDL_SCANCODE_LEFT:
-            gb->input.left = is_pressed; break;
+    int keys;
 
-        default: break;
-    }
+    do keys = SDL_AtomicGet(&gb->input.keys);
+    while(!SDL_AtomicCAS(&gb->input.keys, keys, is_pressed ? keys | key : keys & ~key));
 }
 
 uint8_t joypad_state(GameBoy *gb) {
     uint8_t joypad = SREAD8(JOYP);
+    const int keys = SDL_AtomicGet(&gb->input.keys);
 
     if((joypad & JOYP_DIR) == 0) {
-        SET_KEY(KEY_UP_SELECT, gb->input.up, joypad);
-        SET_KEY(KEY_RIGHT_A, gb->input.right, joypad);
-        SET_KEY(KEY_DOWN_START, gb->input.down, joypad);
-        SET_KEY(KEY_LEFT_B, gb->input.left, joypad);
+        SET_KEY(KEY_UP_SELECT, keys & INPUT_UP, joypad);
+        SET_KEY(KEY_RIGHT_A, keys & INPUT_RIGHT, joypad);
+        SET_KEY(KEY_DOWN_START, keys & INPUT_DOWN, joypad);
+        SET_KEY(KEY_LEFT_B, keys & INPUT_LEFT, joypad);
 
     } else if((joypad & JOYP_BTN) == 0) {
-        SET_KEY(KEY_UP_SELECT, gb->input.select, joypad);
-        SET_KEY(KEY_RIGHT_A, gb->input.a, joypad);
-        SET_KEY(KEY_DOWN_START, gb->input.start, joypad);
-        SET_KEY(KEY_LEFT_B, gb->input.b, joypad);
+        SET_KEY(KEY_UP_SELECT, keys & INPUT_SELECT, joypad);
+        SET_KEY(KEY_RIGHT_A, keys & INPUT_A, joypad);
+        SET_KEY(KEY_DOWN_START, keys & INPUT_START, joypad);
+        SET_KEY(KEY_LEFT_B, keys & INPUT_B, joypad);
     }
     
     SWRITE8(JOYP, joypad);
@@ -316,9 +316,7 @@ void op_ld_hlp_d8(GameBoy *gb, const uint8_t operand) {
 
 // 0x37: SCF (- 0 0 1)
 void op_scf(GameBoy *gb) {
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    FSET(FLAG_CARRY, 1);
+    REG(F) = FLAGS(FGET(FLAG_ZERO), 0, 0, 1);
 }
 
 // 0x38: JR C, r8 (- - - -)
@@ -363,9 +361,7 @@ void op_ld_a_d8(GameBoy *gb, const uint8_t operand) {
 
 // 0x3F: CCF (- 0 0 C)
 void op_ccf(GameBoy *gb) {
-    FSET(FLAG_SUBTRACT, 0);
-    FSET(FLAG_HALFCARRY, 0);
-    FSET(FLAG_CARRY, !FGET(FLAG_CARRY));
+    REG(F) = FLAGS(FGET(FLAG_ZERO), 0, 0, !FGET(FLAG_CARRY));
 }
 
 // 0x40: LD B, B (- - - -)
@@ -652,7 +648,18 @@ void op_ld_hlp_l(GameBoy *gb) {
 
 // 0x76: HALT (- - - -)
 void op_halt(GameBoy *gb) {
-    gb->cpu.is_halted = true;
+
+    const bool is_pending = gb->cpu.pending_interrupts != 0;
+
+    // Right after EI, IME is set as the HALT ends: the interrupt is serviced and returns to the HALT, which runs again
+    if(gb->cpu.is_ime_scheduled && is_pending)
+        REG(PC)--;
+
+    // The pending interrupt ends the halt straight away but isn't serviced
+    else if(!REG(IME) && is_pending)
+        gb->cpu.is_halt_bug = true;
+    else
+        gb->cpu.is_halted = true;
 }
 
 // 0x77: LD (HL), A (- - - -)
@@ -1185,7 +1192,7 @@ void op_ret_c(GameBoy *gb) {
 // 0xD9: RETI (- - - -)
 void op_reti(GameBoy *gb) {
     op_ret(gb); 
-    op_ei(gb);
+    REG(IME) = true;
 }
 
 // 0xDA: JP C, a16 (- - - -)
@@ -1300,6 +1307,7 @@ void op_ld_a_cp(GameBoy *gb) {
 // 0xF3: DI (- - - -)
 void op_di(GameBoy *gb) {
    REG(IME) = false; 
+   gb->cpu.is_ime_scheduled = false;
 }
 
 // 0xF5: PUSH AF (- - - -)
@@ -1339,7 +1347,7 @@ void op_ld_a_a16p(GameBoy *gb, const uint16_t operand) {
 
 // 0xFB: EI (- - - -)
 void op_ei(GameBoy *gb) {
-    REG(IME) = true;
+    gb->cpu.is_ime_scheduled = true;
 }
 
 // 0xFE: CP d8 (Z 1 H C)
@@ -4,6 +4,12 @@
 #include "input.h"
 #include "cpu.h"
 #include "mmu.h"
+#include "trace.h"
+#include "profiler.h"
+#include "timeline.h"
+#include "idle.h"
+#include "icache.h"
+#include "jit.h"
 
 static void reset_hw_registers(GameBoy *);
 
@@ -12,6 +18,12 @@ void init(GameBoy *gb) {
     init_mmu(gb);
     init_ppu(gb);
     init_apu(gb);
+    init_trace(gb);
+    init_profiler(gb);
+    init_timeline(gb);
+    init_idle_loop(gb);
+    init_icache(gb);
+    init_jit(gb);
 
     reset(gb);
 }
@@ -22,6 +34,7 @@ void reset(GameBoy *gb) {
     reset_ppu(gb);
     reset_input(gb);
     reset_apu(gb);
+    reset_idle_loop(gb);
     reset_hw_registers(gb);
 }
 
@@ -0,0 +1,1147 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include "jgbc.h"
+#include "mmu.h"
+#include "cpu.h"
+#include "idle.h"
+#include "icache.h"
+#include "jit.h"
+
+#ifdef JIT_HOST_X64
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+static bool can_run_block(const GameBoy *, uint16_t);
+static bool find_region(GameBoy *, uint16_t, CodeRegion *);
+static bool translate(GameBoy *, uint16_t, const CodeRegion *);
+static void drop_block(JitBlock *, uint8_t *);
+static void flush_blocks(GameBoy *);
+
+#ifdef JIT_HOST_X64
+static bool protect_code(Jit *, bool);
+static bool emit_block(GameBoy *, uint16_t, const CodeRegion *);
+static MemoryAccess access_of(uint8_t, uint8_t);
+static bool is_block_access(uint16_t, bool);
+static bool is_control_flow(uint8_t);
+static EmitResult emit_instr(GameBoy *, Emitter *, uint16_t, const DecodedInstr *, int32_t);
+static bool is_native(uint8_t);
+static uint8_t native_ticks(uint8_t);
+static EmitResult emit_native(Emitter *, uint8_t, uint16_t, uint16_t, uint16_t);
+static void emit_opcode_call(Emitter *, const DecodedInstr *, bool);
+static void emit_step_check(Emitter *, uint16_t, int32_t);
+static void emit_access_guard(Emitter *, MemoryAccess, uint16_t, int32_t);
+static void emit_guard(Emitter *, bool, uint16_t, int32_t);
+static void emit_alu(Emitter *, AluOperation);
+static void emit_inc_dec(Emitter *, uint32_t, bool);
+static void emit_flags(Emitter *, bool, bool, uint8_t);
+static void emit_read(Emitter *);
+static void emit_write(Emitter *);
+static void emit_exit(Emitter *, uint32_t, uint16_t, bool, int32_t);
+
+static void emit_prologue(Emitter *);
+static void emit_epilogue(Emitter *);
+static void emit_call(Emitter *, uintptr_t);
+static void emit_arg_gb(Emitter *);
+static void emit_arg_reg(Emitter *, uint8_t, uint8_t);
+static void emit_arg_imm(Emitter *, uint8_t, uint32_t);
+static void emit_mov_imm(Emitter *, uint8_t, uint32_t);
+static void emit_mem(Emitter *, uint8_t, uint32_t);
+static void emit_load8(Emitter *, uint8_t, uint32_t);
+static void emit_load16(Emitter *, uint8_t, uint32_t);
+static void emit_store8(Emitter *, uint32_t, uint8_t);
+static void emit_store8_imm(Emitter *, uint32_t, uint8_t);
+static void emit_store16_imm(Emitter *, uint32_t, uint16_t);
+static void emit_mem8_imm(Emitter *, uint8_t, uint32_t, uint8_t);
+static void emit_step16(Emitter *, uint32_t, bool);
+static void emit_add_ticks(Emitter *, uint16_t);
+static uint32_t emit_jcc(Emitter *, uint8_t);
+static uint32_t emit_jmp(Emitter *);
+static void patch_here(Emitter *, uint32_t);
+static void emit8(Emitter *, uint8_t);
+static void emit16(Emitter *, uint16_t);
+static void emit32(Emitter *, uint32_t);
+static void emit64(Emitter *, uint64_t);
+#endif
+
+
+void init_jit(GameBoy *gb) {
+    gb->jit.is_enabled = false;
+    gb->jit.is_invalidated = false;
+    gb->jit.code = NULL;
+    gb->jit.code_used = 0;
+    gb->jit.rom_banks = NULL;
+    gb->jit.wram_banks = NULL;
+    gb->jit.hram = NULL;
+    gb->jit.wram_coverage = NULL;
+    gb->jit.hram_coverage = NULL;
+}
+
+// Allocates the executable memory and the blocks, returns false if the host can't run translated code
+// Hosts that never allow anonymous memory to become executable (SELinux without execmem) keep interpreting
+bool start_jit(GameBoy *gb) {
+
+#ifdef JIT_HOST_X64
+    Jit *jit = &gb->jit;
+
+    if(jit->code == NULL) {
+
+#ifdef _WIN32
+        jit->code = VirtualAlloc(NULL, JIT_CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+        void *code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        jit->code = code != MAP_FAILED ? code : NULL;
+#endif
+
+        if(jit->code == NULL)
+            return false;
+
+        if(!protect_code(jit, false)) {
+#ifdef _WIN32
+            VirtualFree(jit->code, 0, MEM_RELEASE);
+#else
+            munmap(jit->code, JIT_CODE_SIZE);
+#endif
+            jit->code = NULL;
+            return false;
+        }
+
+        jit->wram_banks = malloc(sizeof(JitBlock *) * WRAM_BANK_COUNT);
+        jit->wram_coverage = malloc(sizeof(uint8_t *) * WRAM_BANK_COUNT);
+
+        for(uint8_t i = 0; i < WRAM_BANK_COUNT; ++i) {
+            jit->wram_banks[i] = calloc(WRAM_BANK_SIZE, sizeof(JitBlock));
+            jit->wram_coverage[i] = calloc(WRAM_BANK_SIZE, sizeof(uint8_t));
+        }
+
+        jit->hram = calloc(HRAM_SIZE, sizeof(JitBlock));
+        jit->hram_coverage = calloc(HRAM_SIZE, sizeof(uint8_t));
+    }
+
+    jit->is_enabled = true;
+    return true;
+#else
+    (void) gb;
+    return false;
+#endif
+}
+
+// Runs the block starting at the PC once it is hot, as a single step as long as all of its instructions
+// It stops before the next event and before any access to the IO registers, so nothing else could have seen the steps between
+// Returns false if no instruction ran, the interpreter runs the next one
+bool execute_block(GameBoy *gb) {
+
+    const uint16_t start = REG(PC);
+    CodeRegion region;
+
+    if(!can_run_block(gb, start) || !find_region(gb, start, &region))
+        return false;
+
+    JitBlock *block = &region.blocks[region.offset];
+
+    if(block->runs == JIT_NEVER)
+        return false;
+
+    if(block->code == NULL) {
+
+        if(++block->runs < JIT_HOT_RUNS)
+            return false;
+
+        if(!translate(gb, start, &region)) {
+            block->runs = JIT_NEVER;
+            return false;
+        }
+    }
+
+    gb->jit.is_invalidated = false;
+    gb->cpu.ticks = 0;
+
+    const int32_t last = block->code(gb, next_event(gb));
+
+    if(last < 0) {
+        gb->cpu.ticks = CPU_STEP;
+        return false;
+    }
+
+    // The idle loop only sees the last instruction, a block that started outside of the loop has left it
+    IdleLoop *idle = &gb->idle;
+
+    if(idle->is_enabled) {
+
+        if(idle->end != 0 && (start < idle->start || start >= idle->end))
+            reset_idle_loop(gb);
+
+        update_idle_loop(gb, last);
+    }
+
+    return true;
+}
+
+// Called on every write to the RAM code can run from, and by the debugger when it patches the ROM
+// The blocks covering the byte are dropped and translated again once hot
+void invalidate_blocks(GameBoy *gb, uint16_t address) {
+
+    if(gb->jit.code == NULL)
+        return;
+
+    // The echo of the work RAM changes the same bytes
+    if(address >= WRAM00_MIRROR_START && address <= WRAMNN_MIRROR_END)
+        address -= WRAM00_MIRROR_START - WRAM00_START;
+
+    CodeRegion region;
+
+    if(!find_region(gb, address, &region))
+        return;
+
+    const uint16_t offset = region.offset;
+    uint8_t *coverage = region.coverage;
+
+    // The new code may start a block
+    if(region.blocks[offset].runs == JIT_NEVER)
+        region.blocks[offset].runs = 0;
+
+    // The ROM isn't counted, every block before the byte is checked
+    if(coverage != NULL && coverage[offset] == 0)
+        return;
+
+    for(uint16_t i = 0; i < JIT_BLOCK_MAX_SIZE && i <= offset && (coverage == NULL || coverage[offset] > 0); ++i) {
+
+        JitBlock *block = &region.blocks[offset - i];
+
+        if(block->code != NULL && block->size > i)
+            drop_block(block, coverage == NULL ? NULL : &coverage[offset - i]);
+    }
+
+    gb->jit.is_invalidated = true;
+}
+
+// Every instruction is recorded or watched, or the step has to end after the next instruction
+static bool can_run_block(const GameBoy *gb, const uint16_t address) {
+
+    if(gb->trace.is_recording || gb->profiler.is_enabled || gb->mmu.watch.is_armed)
+        return false;
+
+    // EI takes effect after the next instruction, the HALT bug reads its opcode twice
+    if(gb->cpu.is_ime_scheduled || gb->cpu.is_halt_bug)
+        return false;
+
+    // The idle loop skip already runs the pure loops faster
+    const IdleLoop *idle = &gb->idle;
+    return !(idle->is_enabled && idle->is_pure && address >= idle->start && address < idle->end);
+}
+
+// Blocks of the bank mapped at an address, false if the code there is always interpreted
+static bool find_region(GameBoy *gb, const uint16_t address, CodeRegion *region) {
+
+    Jit *jit = &gb->jit;
+
+    // 16KB ROM Bank 00 and NN
+    if(address <= ROMNN_END) {
+
+        if(jit->rom_banks == NULL)
+            jit->rom_banks = calloc(gb->cart.rom_size, sizeof(JitBlock *));
+
+        const uint16_t bank = address <= ROM00_END ? gb->mmu.rom00_bank : gb->mmu.rom_bank;
+
+        if(jit->rom_banks[bank] == NULL)
+            jit->rom_banks[bank] = calloc(ROM_BANK_SIZE, sizeof(JitBlock));
+
+        region->blocks = jit->rom_banks[bank];
+        region->coverage = NULL;
+        region->offset = address & (ROM_BANK_SIZE - 1);
+        region->size = ROM_BANK_SIZE;
+        return true;
+    }
+    // 4KB Work RAM Bank 00 and NN
+    else if(address >= WRAM00_START && address <= WRAMNN_END) {
+
+        const uint8_t bank = address <= WRAM00_END ? 0 : gb->mmu.wram_bank;
+
+        region->blocks = jit->wram_banks[bank];
+        region->coverage = jit->wram_coverage[bank];
+        region->offset = address & (WRAM_BANK_SIZE - 1);
+        region->size = WRAM_BANK_SIZE;
+        return true;
+    }
+    // 127B High RAM
+    else if(address >= HRAM_START && address <= HRAM_END) {
+
+        region->blocks = jit->hram;
+        region->coverage = jit->hram_coverage;
+        region->offset = address - HRAM_START;
+        region->size = HRAM_END - HRAM_START + 1;
+        return true;
+    }
+
+    return false;
+}
+
+static void drop_block(JitBlock *block, uint8_t *coverage) {
+
+    for(uint8_t i = 0; coverage != NULL && i < block->size; ++i)
+        coverage[i]--;
+
+    block->code = NULL;
+    block->size = 0;
+    block->runs = 0;
+}
+
+// Forgets every block to reuse the executable memory, only done between blocks
+static void flush_blocks(GameBoy *gb) {
+
+    Jit *jit = &gb->jit;
+
+    if(jit->rom_banks != NULL) {
+        for(uint16_t i = 0; i < gb->cart.rom_size; ++i) {
+            if(jit->rom_banks[i] != NULL)
+                memset(jit->rom_banks[i], 0, ROM_BANK_SIZE * sizeof(JitBlock));
+        }
+    }
+
+    for(uint8_t i = 0; i < WRAM_BANK_COUNT; ++i) {
+        memset(jit->wram_banks[i], 0, WRAM_BANK_SIZE * sizeof(JitBlock));
+        memset(jit->wram_coverage[i], 0, WRAM_BANK_SIZE);
+    }
+
+    memset(jit->hram, 0, HRAM_SIZE * sizeof(JitBlock));
+    memset(jit->hram_coverage, 0, HRAM_SIZE);
+
+    jit->code_used = 0;
+}
+
+#ifdef JIT_HOST_X64
+
+#define OFFSET(field) ((uint32_t) offsetof(GameBoy, field))
+
+// Operand index (B C D E H L (HL) A) to register
+static const uint32_t reg_offsets[8] = {
+    OFFSET(cpu.reg.B), OFFSET(cpu.reg.C), OFFSET(cpu.reg.D), OFFSET(cpu.reg.E),
+    OFFSET(cpu.reg.H), OFFSET(cpu.reg.L), 0, OFFSET(cpu.reg.A)
+};
+
+// Operand index (BC DE HL SP) to register pair
+static const uint32_t pair_offsets[4] = {
+    OFFSET(cpu.reg.BC), OFFSET(cpu.reg.DE), OFFSET(cpu.reg.HL), OFFSET(cpu.reg.SP)
+};
+
+#ifdef _WIN32
+static const uint8_t host_args[4] = { HOST_ECX, HOST_EDX, HOST_R8D, HOST_R9D };
+#define HOST_FRAME 40 // Shadow space of the calls, keeps the stack aligned
+#else
+static const uint8_t host_args[4] = { HOST_EDI, HOST_ESI, HOST_EDX, HOST_ECX };
+#define HOST_FRAME 8
+#endif
+
+// Memory the instruction reads or writes besides its own bytes
+static MemoryAccess access_of(const uint8_t opcode, const uint8_t cb_opcode) {
+
+    switch(opcode) {
+
+        case 0x02: return (MemoryAccess) { AccessBC, true };
+        case 0x0A: return (MemoryAccess) { AccessBC, false };
+        case 0x12: return (MemoryAccess) { AccessDE, true };
+        case 0x1A: return (MemoryAccess) { AccessDE, false };
+
+        // LD (HL+),A LD (HL-),A INC (HL) DEC (HL) LD (HL),n
+        case 0x22: case 0x32: case 0x34: case 0x35: case 0x36:
+            return (MemoryAccess) { AccessHL, true };
+
+        // LD A,(HL+) LD A,(HL-)
+        case 0x2A: case 0x3A:
+            return (MemoryAccess) { AccessHL, false };
+
+        case 0x08: return (MemoryAccess) { AccessAbsolutePair, true };
+        case 0xE0: return (MemoryAccess) { AccessHigh, true };
+        case 0xF0: return (MemoryAccess) { AccessHigh, false };
+        case 0xE2: return (MemoryAccess) { AccessHighC, true };
+        case 0xF2: return (MemoryAccess) { AccessHighC, false };
+        case 0xEA: return (MemoryAccess) { AccessAbsolute, true };
+        case 0xFA: return (MemoryAccess) { AccessAbsolute, false };
+
+        // RET cc RET RETI POP rr
+        case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xC9: case 0xD9:
+        case 0xC1: case 0xD1: case 0xE1: case 0xF1:
+            return (MemoryAccess) { AccessPop, false };
+
+        // CALL cc,nn CALL nn PUSH rr RST n
+        case 0xC4: case 0xCC: case 0xD4: case 0xDC: case 0xCD:
+        case 0xC5: case 0xD5: case 0xE5: case 0xF5:
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+            return (MemoryAccess) { AccessPush, true };
+
+        // BIT b,(HL) only reads, the other operations on (HL) write it back
+        case 0xCB:
+            if((cb_opcode & 0x7) != 6)
+                return (MemoryAccess) { AccessNone, false };
+
+            return (MemoryAccess) { AccessHL, (cb_opcode & 0xC0) != 0x40 };
+    }
+
+    // LD (HL),r
+    if(opcode >= 0x70 && opcode <= 0x77 && opcode != 0x76)
+        return (MemoryAccess) { AccessHL, true };
+
+    // LD r,(HL) ALU A,(HL)
+    if(opcode >= 0x40 && opcode <= 0xBF && (opcode & 0x7) == 6 && opcode != 0x76)
+        return (MemoryAccess) { AccessHL, false };
+
+    return (MemoryAccess) { AccessNone, false };
+}
+
+// The IO registers and IE change how the other components run or depend on their clocks, a write to the ROM goes to the MBC
+// The emitted guards check the same addresses
+static bool is_block_access(const uint16_t address, const bool is_write) {
+
+    if(address >= IO_START && address <= IO_END)
+        return false;
+
+    if(address == IE_START_END)
+        return false;
+
+    return !(is_write && address <= ROMNN_END);
+}
+
+// JR JP CALL RET RETI RST, the block ends with them
+static bool is_control_flow(const uint8_t opcode) {
+
+    switch(opcode) {
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA: case 0xE9:
+        case 0xCD: case 0xC4: case 0xCC: case 0xD4: case 0xDC:
+        case 0xC9: case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xD9:
+            return true;
+
+        default:
+            return (opcode & 0xC7) == 0xC7;
+    }
+}
+
+// Translates the instructions from the start up to the first branch or the first one a block can't run
+// Returns false if not even the first one can be translated
+static bool translate(GameBoy *gb, const uint16_t start, const CodeRegion *region) {
+
+    Jit *jit = &gb->jit;
+
+    if(JIT_CODE_SIZE - jit->code_used < JIT_BLOCK_CODE_MAX)
+        flush_blocks(gb);
+
+    if(!protect_code(jit, true))
+        return false;
+
+    const bool is_emitted = emit_block(gb, start, region);
+
+    // No block can run from a buffer that can't be made executable again
+    if(!protect_code(jit, false)) {
+        jit->is_enabled = false;
+        return false;
+    }
+
+    return is_emitted;
+}
+
+// The buffer is either writable or executable, hardened hosts refuse mappings that are both
+static bool protect_code(Jit *jit, const bool is_writable) {
+#ifdef _WIN32
+    DWORD previous;
+    return VirtualProtect(jit->code, JIT_CODE_SIZE, is_writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &previous);
+#else
+    return mprotect(jit->code, JIT_CODE_SIZE, is_writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+#endif
+}
+
+// Emits the block at the end of the used code, the buffer has to be writable
+static bool emit_block(GameBoy *gb, const uint16_t start, const CodeRegion *region) {
+
+    Jit *jit = &gb->jit;
+
+    Emitter *e = malloc(sizeof(Emitter));
+    e->code = jit->code + jit->code_used;
+    e->size = 0;
+    e->is_write_pending = false;
+    e->exit_count = 0;
+
+    emit_prologue(e);
+
+    const uint16_t left = region->size - region->offset;
+    const uint16_t limit = left < JIT_BLOCK_MAX_SIZE ? left : JIT_BLOCK_MAX_SIZE;
+
+    uint16_t address = start;
+    int32_t last = -1;
+    EmitResult result = Emitted;
+
+    while(result != EmittedEnd) {
+
+        const DecodedInstr instr = *fetch_instr(gb, address);
+
+        if(address - start + instr.length > limit)
+            break;
+
+        result = emit_instr(gb, e, address, &instr, last);
+
+        if(result == NotEmitted)
+            break;
+
+        last = address;
+        address += instr.length;
+    }
+
+    if(last < 0) {
+        free(e);
+        return false;
+    }
+
+    // Ran into an instruction it can't translate, or the end of the block
+    if(result != EmittedEnd)
+        emit_exit(e, emit_jmp(e), address, false, last);
+
+    const uint32_t epilogue = e->size;
+    emit_epilogue(e);
+
+    for(uint16_t i = 0; i < e->exit_count; ++i) {
+
+        const BlockExit *exit = &e->exits[i];
+        patch_here(e, exit->patch);
+
+        if(!exit->is_pc_set)
+            emit_store16_imm(e, OFFSET(cpu.reg.PC), exit->pc);
+
+        emit_mov_imm(e, HOST_EAX, exit->last);
+
+        emit8(e, 0xE9); // jmp epilogue
+        emit32(e, epilogue - (e->size + 4));
+    }
+
+    assert(e->size <= JIT_BLOCK_CODE_MAX);
+
+    JitBlock *block = &region->blocks[region->offset];
+    block->code = (int32_t (*)(GameBoy *, uint32_t)) (void *) e->code;
+    block->size = address - start;
+
+    if(region->coverage != NULL) {
+        for(uint16_t i = 0; i < block->size; ++i)
+            region->coverage[region->offset + i]++;
+    }
+
+    // The next block starts aligned
+    jit->code_used = (jit->code_used + e->size + 15) & ~15u;
+
+    free(e);
+    return true;
+}
+
+static EmitResult emit_instr(GameBoy *gb, Emitter *e, const uint16_t address, const DecodedInstr *instr, const int32_t last) {
+
+    const uint8_t opcode = SREAD8(address);
+    const uint8_t cb_opcode = opcode == 0xCB ? SREAD8(address + 1) : 0;
+    const uint16_t next = address + instr->length;
+    const MemoryAccess access = access_of(opcode, cb_opcode);
+
+    // STOP, HALT and EI change how the next steps run
+    if(opcode == 0x10 || opcode == 0x76 || opcode == 0xFB)
+        return NotEmitted;
+
+    // Fixed addresses are checked now, the block ends before the instruction
+    switch(access.source) {
+
+        case AccessHigh:
+            if(!is_block_access(IO_START + (uint8_t) instr->operand, access.is_write))
+                return NotEmitted;
+
+            break;
+
+        case AccessAbsolute:
+            if(!is_block_access(instr->operand, access.is_write))
+                return NotEmitted;
+
+            break;
+
+        case AccessAbsolutePair:
+            if(!is_block_access(instr->operand, true) || !is_block_access(instr->operand + 1, true))
+                return NotEmitted;
+
+            break;
+
+        default:
+            break;
+    }
+
+    if(last >= 0)
+        emit_step_check(e, address, last);
+
+    // The others are checked when it runs, the block leaves before the instruction
+    emit_access_guard(e, access, address, last);
+    e->is_write_pending = access.is_write;
+
+    if(is_native(opcode)) {
+        emit_add_ticks(e, CPU_STEP + instr->ticks + native_ticks(opcode));
+        return emit_native(e, opcode, address, next, instr->operand);
+    }
+
+    // Everything else calls the interpreter's opcode function, which expects the PC past the instruction
+    emit_store16_imm(e, OFFSET(cpu.reg.PC), next);
+    emit_add_ticks(e, CPU_STEP + instr->ticks);
+    emit_opcode_call(e, instr, find_instr(gb, address).signed_operand);
+
+    if(!is_control_flow(opcode))
+        return Emitted;
+
+    emit_exit(e, emit_jmp(e), 0, true, address);
+    return EmittedEnd;
+}
+
+// Instructions translated to host code, the others are calls to their opcode function
+static bool is_native(const uint8_t opcode) {
+
+    // LD r,r' LD r,(HL) LD (HL),r ALU A,r ALU A,(HL)
+    if(opcode >= 0x40 && opcode <= 0xBF)
+        return opcode != 0x76;
+
+    // LD r,n LD rr,nn INC rr DEC rr ALU A,n
+    if((opcode & 0xC7) == 0x06 || (opcode & 0xCF) == 0x01 || (opcode & 0xCF) == 0x03 || (opcode & 0xCF) == 0x0B)
+        return true;
+
+    if((opcode & 0xC7) == 0xC6)
+        return true;
+
+    // INC r DEC r
+    if((opcode & 0xC6) == 0x04 && opcode < 0x40)
+        return opcode != 0x34 && opcode != 0x35;
+
+    switch(opcode) {
+        case 0x00:
+        case 0x02: case 0x12: case 0x0A: case 0x1A:
+        case 0x22: case 0x32: case 0x2A: case 0x3A:
+        case 0xE0: case 0xF0:
+        case 0x2F: case 0x37: case 0x3F:
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// T-cycles the opcode function would add (memory accesses and 16 bit increments), the branches add theirs when taken
+static uint8_t native_ticks(const uint8_t opcode) {
+
+    if(access_of(opcode, 0).source != AccessNone)
+        return CPU_STEP;
+
+    if((opcode & 0xCF) == 0x03 || (opcode & 0xCF) == 0x0B)
+        return CPU_STEP;
+
+    return 0;
+}
+
+// The address was left in EAX by the access guard
+static EmitResult emit_native(Emitter *e, const uint8_t opcode, const uint16_t address, const uint16_t next, const uint16_t operand) {
+
+    const uint8_t dest = (opcode >> 3) & 0x7;
+    const uint8_t src = opcode & 0x7;
+    const uint32_t a = reg_offsets[7];
+    const uint32_t hl = pair_offsets[2];
+
+    // LD r,(HL) LD (HL),r LD r,r'
+    if(opcode >= 0x40 && opcode <= 0x7F) {
+
+        if(src == 6) {
+            emit_read(e);
+            emit_store8(e, reg_offsets[dest], HOST_EAX);
+        }
+        else if(dest == 6) {
+            emit_load8(e, HOST_ECX, reg_offsets[src]);
+            emit_write(e);
+        }
+        else if(src != dest) {
+            emit_load8(e, HOST_EAX, reg_offsets[src]);
+            emit_store8(e, reg_offsets[dest], HOST_EAX);
+        }
+
+        return Emitted;
+    }
+
+    // ALU A,r ALU A,(HL) ALU A,n
+    if(opcode >= 0x80 && opcode <= 0xBF) {
+
+        if(src == 6) {
+            emit_read(e);
+            emit8(e, 0x89); emit8(e, 0xC1); // mov ecx, eax
+        }
+        else
+            emit_load8(e, HOST_ECX, reg_offsets[src]);
+
+        emit_alu(e, dest);
+        return Emitted;
+    }
+
+    if((opcode & 0xC7) == 0xC6) {
+        emit_mov_imm(e, HOST_ECX, operand);
+        emit_alu(e, dest);
+        return Emitted;
+    }
+
+    // LD r,n LD (HL),n
+    if((opcode & 0xC7) == 0x06) {
+
+        if(dest == 6) {
+            emit_mov_imm(e, HOST_ECX, operand);
+            emit_write(e);
+        }
+        else
+            emit_store8_imm(e, reg_offsets[dest], operand);
+
+        return Emitted;
+    }
+
+    // LD rr,nn INC rr DEC rr
+    if((opcode & 0xCF) == 0x01) {
+        emit_store16_imm(e, pair_offsets[opcode >> 4], operand);
+        return Emitted;
+    }
+
+    if((opcode & 0xCF) == 0x03 || (opcode & 0xCF) == 0x0B) {
+        emit_step16(e, pair_offsets[opcode >> 4], (opcode & 0xCF) == 0x0B);
+        return Emitted;
+    }
+
+    // INC r DEC r
+    if((opcode & 0xC6) == 0x04) {
+        emit_inc_dec(e, reg_offsets[dest], opcode & 1);
+        return Emitted;
+    }
+
+    switch(opcode) {
+
+        case 0x00:
+            return Emitted;
+
+        // LD (BC),A LD (DE),A LD (HL+),A LD (HL-),A
+        case 0x02: case 0x12: case 0x22: case 0x32:
+            emit_load8(e, HOST_ECX, a);
+            emit_write(e);
+
+            if(opcode == 0x22 || opcode == 0x32)
+                emit_step16(e, hl, opcode == 0x32);
+
+            return Emitted;
+
+        // LD A,(BC) LD A,(DE) LD A,(HL+) LD A,(HL-)
+        case 0x0A: case 0x1A: case 0x2A: case 0x3A:
+            emit_read(e);
+            emit_store8(e, a, HOST_EAX);
+
+            if(opcode == 0x2A || opcode == 0x3A)
+                emit_step16(e, hl, opcode == 0x3A);
+
+            return Emitted;
+
+        // LDH (n),A LDH A,(n) to the high RAM
+        case 0xE0:
+            emit_mov_imm(e, HOST_EAX, IO_START + (uint8_t) operand);
+            emit_load8(e, HOST_ECX, a);
+            emit_write(e);
+            return Emitted;
+
+        case 0xF0:
+            emit_mov_imm(e, HOST_EAX, IO_START + (uint8_t) operand);
+            emit_read(e);
+            emit_store8(e, a, HOST_EAX);
+            return Emitted;
+
+        // CPL SCF CCF
+        case 0x2F:
+            emit_mem8_imm(e, 6, a, 0xFF); // xor
+            emit_mem8_imm(e, 1, OFFSET(cpu.reg.F), FLAGS(0, 1, 1, 0)); // or
+            return Emitted;
+
+        case 0x37:
+            emit_mem8_imm(e, 4, OFFSET(cpu.reg.F), FLAGS(1, 0, 0, 0)); // and
+            emit_mem8_imm(e, 1, OFFSET(cpu.reg.F), FLAGS(0, 0, 0, 1)); // or
+            return Emitted;
+
+        case 0x3F:
+            emit_mem8_imm(e, 4, OFFSET(cpu.reg.F), FLAGS(1, 0, 0, 1)); // and
+            emit_mem8_imm(e, 6, OFFSET(cpu.reg.F), FLAGS(0, 0, 0, 1)); // xor
+            return Emitted;
+
+        // JR e JP nn
+        case 0x18: case 0xC3: {
+            const uint16_t target = opcode == 0x18 ? next + (int8_t) operand : operand;
+
+            emit_add_ticks(e, CPU_STEP);
+            emit_exit(e, emit_jmp(e), target, false, address);
+            return EmittedEnd;
+        }
+
+        // JR cc,e JP cc,nn (NZ Z NC C)
+        default: {
+            const uint16_t target = opcode < 0x40 ? next + (int8_t) operand : operand;
+            const uint8_t condition = (opcode >> 3) & 0x3;
+            const uint8_t flag = condition < 2 ? FLAGS(1, 0, 0, 0) : FLAGS(0, 0, 0, 1);
+
+            emit_mem8_imm(e, 0, OFFSET(cpu.reg.F), flag); // test
+            const uint32_t taken = emit_jcc(e, condition & 1 ? HOST_CC_NE : HOST_CC_E);
+
+            emit_exit(e, emit_jmp(e), next, false, address);
+
+            patch_here(e, taken);
+            emit_add_ticks(e, CPU_STEP);
+            emit_exit(e, emit_jmp(e), target, false, address);
+            return EmittedEnd;
+        }
+    }
+}
+
+static void emit_opcode_call(Emitter *e, const DecodedInstr *instr, const bool is_signed) {
+
+    if(instr->operand_length == 1)
+        emit_arg_imm(e, 1, is_signed ? (uint32_t) (int32_t) (int8_t) instr->operand : (uint8_t) instr->operand);
+    else if(instr->operand_length == 2)
+        emit_arg_imm(e, 1, instr->operand);
+
+    emit_arg_gb(e);
+    emit_call(e, (uintptr_t) instr->execute);
+}
+
+// Before every instruction but the first, the block stops once the step reaches the next event
+// or when the last instruction dropped a block, which can be this one
+static void emit_step_check(Emitter *e, const uint16_t address, const int32_t last) {
+
+    emit_load16(e, HOST_EAX, OFFSET(cpu.ticks));
+    emit8(e, 0x39); emit8(e, 0xE8); // cmp eax, ebp
+    emit_exit(e, emit_jcc(e, HOST_CC_AE), address, false, last);
+
+    if(e->is_write_pending) {
+        emit_mem8_imm(e, 7, OFFSET(jit.is_invalidated), 0); // cmp
+        emit_exit(e, emit_jcc(e, HOST_CC_NE), address, false, last);
+    }
+}
+
+static void emit_access_guard(Emitter *e, const MemoryAccess access, const uint16_t address, const int32_t last) {
+
+    switch(access.source) {
+
+        case AccessBC:
+        case AccessDE:
+        case AccessHL:
+            emit_load16(e, HOST_EAX, pair_offsets[access.source - AccessBC]);
+            emit_guard(e, access.is_write, address, last);
+            break;
+
+        case AccessHighC:
+            emit_load8(e, HOST_EAX, reg_offsets[1]);
+            emit8(e, 0x05); // add eax, IO_START
+            emit32(e, IO_START);
+            emit_guard(e, access.is_write, address, last);
+            break;
+
+        // Both bytes, the stack pointer wraps around
+        case AccessPop:
+        case AccessPush:
+            for(uint8_t i = 0; i < 2; ++i) {
+                const int32_t delta = access.source == AccessPop ? i : -1 - i;
+
+                emit_load16(e, HOST_EAX, pair_offsets[3]);
+                emit8(e, 0x05); // add eax, delta
+                emit32(e, delta);
+                emit8(e, 0x25); // and eax, 0xFFFF
+                emit32(e, 0xFFFF);
+                emit_guard(e, access.is_write, address, last);
+            }
+
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Leaves the block before the instruction if the address in EAX can't be accessed (is_block_access), keeps EAX
+static void emit_guard(Emitter *e, const bool is_write, const uint16_t address, const int32_t last) {
+
+    emit8(e, 0x8D); emit8(e, 0x88); // lea ecx, [rax - IO_START]
+    emit32(e, -IO_START);
+    emit8(e, 0x81); emit8(e, 0xF9); // cmp ecx, IO_SIZE
+    emit32(e, IO_SIZE);
+    emit_exit(e, emit_jcc(e, HOST_CC_B), address, false, last);
+
+    emit8(e, 0x3D); // cmp eax, IE
+    emit32(e, IE_START_END);
+    emit_exit(e, emit_jcc(e, HOST_CC_E), address, false, last);
+
+    if(is_write) {
+        emit8(e, 0x3D); // cmp eax, VRAM_START
+        emit32(e, VRAM_START);
+        emit_exit(e, emit_jcc(e, HOST_CC_B), address, false, last);
+    }
+}
+
+// A op= CL, the host computes the same half carry (AF) and carry (CF)
+static void emit_alu(Emitter *e, const AluOperation operation) {
+
+    // add adc sub sbb and xor or cmp al, cl
+    static const uint8_t host_opcodes[8] = { 0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38 };
+
+    emit_load8(e, HOST_EAX, reg_offsets[7]);
+
+    if(operation == AluAdc || operation == AluSbc) {
+        emit_load8(e, HOST_EDX, OFFSET(cpu.reg.F));
+        emit8(e, 0x0F); emit8(e, 0xBA); emit8(e, 0xE2); emit8(e, FLAG_CARRY); // bt edx, FLAG_CARRY
+    }
+
+    emit8(e, host_opcodes[operation]);
+    emit8(e, 0xC8);
+    emit8(e, 0x9C); // pushfq
+    emit8(e, 0x5A); // pop rdx
+
+    if(operation != AluCp)
+        emit_store8(e, reg_offsets[7], HOST_EAX);
+
+    switch(operation) {
+
+        case AluAdd:
+        case AluAdc:
+            emit_flags(e, true, false, 0);
+            break;
+
+        case AluSub:
+        case AluSbc:
+        case AluCp:
+            emit_flags(e, true, false, FLAGS(0, 1, 0, 0));
+            break;
+
+        // The host leaves AF undefined
+        case AluAnd:
+            emit_flags(e, false, false, FLAGS(0, 0, 1, 0));
+            break;
+
+        case AluXor:
+        case AluOr:
+            emit_flags(e, false, false, 0);
+            break;
+    }
+}
+
+// INC and DEC keep the carry
+static void emit_inc_dec(Emitter *e, const uint32_t offset, const bool is_dec) {
+
+    emit_load8(e, HOST_EAX, offset);
+    emit8(e, is_dec ? 0x2C : 0x04); emit8(e, 1); // sub/add al, 1
+    emit8(e, 0x9C); // pushfq
+    emit8(e, 0x5A); // pop rdx
+    emit_store8(e, offset, HOST_EAX);
+
+    emit_flags(e, true, true, is_dec ? FLAGS(0, 1, 0, 0) : 0);
+}
+
+// F from the host flags in EDX, ZF (bit 6) to Z, AF (bit 4) to H and CF (bit 0) to C
+static void emit_flags(Emitter *e, const bool has_half_carry, const bool keeps_carry, const uint8_t set) {
+
+    if(has_half_carry && !keeps_carry) {
+        emit8(e, 0x89); emit8(e, 0xD1); // mov ecx, edx
+        emit8(e, 0x83); emit8(e, 0xE1); emit8(e, 0x01); // and ecx, 1
+        emit8(e, 0xC1); emit8(e, 0xE1); emit8(e, FLAG_CARRY); // shl ecx, FLAG_CARRY
+    }
+
+    emit8(e, 0x83); emit8(e, 0xE2); emit8(e, has_half_carry ? 0x50 : 0x40); // and edx, ZF | AF
+    emit8(e, 0x01); emit8(e, 0xD2); // add edx, edx
+
+    if(keeps_carry) {
+        emit_load8(e, HOST_ECX, OFFSET(cpu.reg.F));
+        emit8(e, 0x83); emit8(e, 0xE1); emit8(e, FLAGS(0, 0, 0, 1)); // and ecx, C
+    }
+
+    if(has_half_carry || keeps_carry) {
+        emit8(e, 0x09); emit8(e, 0xCA); // or edx, ecx
+    }
+
+    if(set != 0) {
+        emit8(e, 0x83); emit8(e, 0xCA); emit8(e, set); // or edx, set
+    }
+
+    emit_store8(e, OFFSET(cpu.reg.F), HOST_EDX);
+}
+
+// EAX = read_byte(gb, EAX, true)
+static void emit_read(Emitter *e) {
+    emit_arg_reg(e, 1, HOST_EAX);
+    emit_arg_imm(e, 2, true);
+    emit_arg_gb(e);
+    emit_call(e, (uintptr_t) &read_byte);
+}
+
+// write_byte(gb, EAX, CL, true), the arguments are moved in an order that doesn't overwrite them on either host
+static void emit_write(Emitter *e) {
+    emit_arg_reg(e, 2, HOST_ECX);
+    emit_arg_reg(e, 1, HOST_EAX);
+    emit_arg_imm(e, 3, true);
+    emit_arg_gb(e);
+    emit_call(e, (uintptr_t) &write_byte);
+}
+
+static void emit_exit(Emitter *e, const uint32_t patch, const uint16_t pc, const bool is_pc_set, const int32_t last) {
+
+    assert(e->exit_count < JIT_MAX_EXITS);
+
+    BlockExit *exit = &e->exits[e->exit_count++];
+    exit->patch = patch;
+    exit->pc = pc;
+    exit->is_pc_set = is_pc_set;
+    exit->last = last;
+}
+
+// The block is called as int32_t block(GameBoy *gb, uint32_t budget), RBX holds gb and EBP the budget
+static void emit_prologue(Emitter *e) {
+
+    emit8(e, 0x53); // push rbx
+    emit8(e, 0x55); // push rbp
+    emit8(e, 0x48); emit8(e, 0x83); emit8(e, 0xEC); emit8(e, HOST_FRAME); // sub rsp, HOST_FRAME
+
+    emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xC0 | host_args[0] << 3 | HOST_EBX); // mov rbx, arg0
+    emit8(e, 0x89); emit8(e, 0xC0 | host_args[1] << 3 | HOST_EBP); // mov ebp, arg1
+}
+
+static void emit_epilogue(Emitter *e) {
+    emit8(e, 0x48); emit8(e, 0x83); emit8(e, 0xC4); emit8(e, HOST_FRAME); // add rsp, HOST_FRAME
+    emit8(e, 0x5D); // pop rbp
+    emit8(e, 0x5B); // pop rbx
+    emit8(e, 0xC3); // ret
+}
+
+static void emit_call(Emitter *e, const uintptr_t function) {
+    emit8(e, 0x48); emit8(e, 0xB8); // mov rax, function
+    emit64(e, function);
+    emit8(e, 0xFF); emit8(e, 0xD0); // call rax
+}
+
+static void emit_arg_gb(Emitter *e) {
+    emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xC0 | HOST_EBX << 3 | host_args[0]); // mov arg0, rbx
+}
+
+static void emit_arg_reg(Emitter *e, const uint8_t index, const uint8_t reg) {
+
+    const uint8_t arg = host_args[index];
+
+    if(arg >= HOST_R8D)
+        emit8(e, 0x41);
+
+    emit8(e, 0x89); emit8(e, 0xC0 | reg << 3 | (arg & 0x7)); // mov arg, reg
+}
+
+static void emit_arg_imm(Emitter *e, const uint8_t index, const uint32_t value) {
+    emit_mov_imm(e, host_args[index], value);
+}
+
+static void emit_mov_imm(Emitter *e, const uint8_t reg, const uint32_t value) {
+
+    if(reg >= HOST_R8D)
+        emit8(e, 0x41);
+
+    emit8(e, 0xB8 + (reg & 0x7)); // mov reg, value
+    emit32(e, value);
+}
+
+// [rbx + offset]
+static void emit_mem(Emitter *e, const uint8_t reg, const uint32_t offset) {
+    emit8(e, 0x80 | reg << 3 | HOST_EBX);
+    emit32(e, offset);
+}
+
+static void emit_load8(Emitter *e, const uint8_t reg, const uint32_t offset) {
+    emit8(e, 0x0F); emit8(e, 0xB6); // movzx reg, byte
+    emit_mem(e, reg, offset);
+}
+
+static void emit_load16(Emitter *e, const uint8_t reg, const uint32_t offset) {
+    emit8(e, 0x0F); emit8(e, 0xB7); // movzx reg, word
+    emit_mem(e, reg, offset);
+}
+
+static void emit_store8(Emitter *e, const uint32_t offset, const uint8_t reg) {
+    emit8(e, 0x88); // mov byte, reg
+    emit_mem(e, reg, offset);
+}
+
+static void emit_store8_imm(Emitter *e, const uint32_t offset, const uint8_t value) {
+    emit8(e, 0xC6); // mov byte, value
+    emit_mem(e, 0, offset);
+    emit8(e, value);
+}
+
+static void emit_store16_imm(Emitter *e, const uint32_t offset, const uint16_t value) {
+    emit8(e, 0x66); emit8(e, 0xC7); // mov word, value
+    emit_mem(e, 0, offset);
+    emit16(e, value);
+}
+
+// Group 1 operation on a byte (0 is test, the others add or adc sbb and sub xor cmp)
+static void emit_mem8_imm(Emitter *e, const uint8_t operation, const uint32_t offset, const uint8_t value) {
+    emit8(e, operation == 0 ? 0xF6 : 0x80);
+    emit_mem(e, operation, offset);
+    emit8(e, value);
+}
+
+static void emit_step16(Emitter *e, const uint32_t offset, const bool is_dec) {
+    emit8(e, 0x66); emit8(e, 0xFF); // inc/dec word
+    emit_mem(e, is_dec, offset);
+}
+
+static void emit_add_ticks(Emitter *e, const uint16_t ticks) {
+    emit8(e, 0x66); emit8(e, 0x81); // add word, ticks
+    emit_mem(e, 0, OFFSET(cpu.ticks));
+    emit16(e, ticks);
+}
+
+// Returns the offset of the rel32 to patch
+static uint32_t emit_jcc(Emitter *e, const uint8_t condition) {
+    emit8(e, 0x0F); emit8(e, 0x80 | condition);
+    emit32(e, 0);
+    return e->size - 4;
+}
+
+static uint32_t emit_jmp(Emitter *e) {
+    emit8(e, 0xE9);
+    emit32(e, 0);
+    return e->size - 4;
+}
+
+static void patch_here(Emitter *e, const uint32_t patch) {
+    const uint32_t relative = e->size - (patch + 4);
+    memcpy(&e->code[patch], &relative, sizeof(relative));
+}
+
+static void emit8(Emitter *e, const uint8_t value) {
+    e->code[e->size++] = value;
+}
+
+static void emit16(Emitter *e, const uint16_t value) {
+    emit8(e, value & 0xFF);
+    emit8(e, value >> 8);
+}
+
+static void emit32(Emitter *e, const uint32_t value) {
+    emit16(e, value & 0xFFFF);
+    emit16(e, value >> 16);
+}
+
+static void emit64(Emitter *e, const uint64_t value) {
+    emit32(e, value & 0xFFFFFFFF);
+    emit32(e, value >> 32);
+}
+
+#else
+
+static bool translate(GameBoy *gb, const uint16_t start, const CodeRegion *region) {
+    (void) gb;
+    (void) start;
+    (void) region;
+    return false;
+}
+
+#endif
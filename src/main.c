@@ -11,11 +11,14 @@
 #include "cart.h"
 #include "mmu.h"
 #include "input.h"
+#include "trace.h"
+#include "jit.h"
 
 
 static void handle_event(GameBoy *, SDL_Event);
 static void set_window_title(GameBoy *);
 static void run(GameBoy *);
+static int emulate(void *);
 static void print_help();
 static void serial_write_handler(uint8_t);
 static CliArgs parse_cli_args(int, const char **);
@@ -59,6 +62,25 @@ int main(const int argc, const char **argv) {
         set_window_title(gb);
     }
 
+    if(args.should_correct_colours)
+        set_colour_correction(gb, true);
+
+    if(args.sample_rate != 0 && !set_sample_rate(gb, args.sample_rate)) {
+        fprintf(stderr, "ERROR: Unsupported sample rate %d\n", args.sample_rate);
+        return EXIT_FAILURE;
+    }
+
+    if(args.trace_path != NULL && !start_trace(gb, args.trace_path)) {
+        fprintf(stderr, "ERROR: Cannot open trace file\n");
+        return EXIT_FAILURE;
+    }
+
+    gb->idle.is_enabled = args.should_skip_idle_loops;
+    gb->icache.is_enabled = args.should_cache_instrs;
+
+    if(args.should_use_jit && !start_jit(gb))
+        fprintf(stderr, "ERROR: Cannot start the JIT (x86-64 hosts allowing executable memory only), interpreting instead\n");
+
     if(args.should_print_serial)
         gb->mmu.serial_write_handler = serial_write_handler;
 
@@ -72,15 +94,41 @@ int main(const int argc, const char **argv) {
     return EXIT_SUCCESS;
 }
 
+// Emulation runs on its own thread so a stalled present (vsync) never stalls the emulator
+// This thread only handles events and presents the frames published by the PPU
 static void run(GameBoy *gb) {
 
     SDL_Event event;
-    gb->is_running = true;
+    SDL_AtomicSet(&gb->is_running, 1);
+
+    SDL_Thread *emulation_thread = SDL_CreateThread(emulate, "emulation", gb);
+
+    while(SDL_AtomicGet(&gb->is_running)) {
+
+        while(SDL_PollEvent(&event))
+            handle_event(gb, event);
 
-    while(gb->is_running) {
+        // Presenting blocks until the next vsync, otherwise wait for a new frame
+        if(gb->ppu.window == NULL || !render(gb))
+            SDL_Delay(1);
+    }
+
+    SDL_WaitThread(emulation_thread, NULL);
+    stop_trace(gb);
+    save_ram(gb);
+}
+
+static int emulate(void *data) {
+
+    GameBoy *gb = data;
 
-        static const uint32_t max_ticks = CLOCK_SPEED / FRAMERATE;
-        uint32_t frame_ticks = 0;
+    const uint64_t frame_duration = SDL_GetPerformanceFrequency() / FRAMERATE;
+    uint64_t next_frame = SDL_GetPerformanceCounter();
+
+    static const uint32_t max_ticks = CLOCK_SPEED / FRAMERATE;
+    uint32_t frame_ticks = 0;
+
+    while(SDL_AtomicGet(&gb->is_running)) {
 
         while(frame_ticks < max_ticks) {
             execute_instr(gb);
@@ -99,21 +147,28 @@ static void run(GameBoy *gb) {
             frame_ticks += gb->cpu.ticks;
         }
 
-        while(SDL_GetQueuedAudioSize(gb->apu.device_id))
-            SDL_Delay(1);
+        // A halted step can go past the end of the frame, the next one is that much shorter
+        frame_ticks -= max_ticks;
 
-        while(SDL_PollEvent(&event))
-            handle_event(gb, event);
+        // Sleep until the next frame is due, the audio rate control absorbs the drift
+        // between this clock and the audio device
+        next_frame += frame_duration;
+        const uint64_t now = SDL_GetPerformanceCounter();
+
+        if(now < next_frame)
+            SDL_Delay((uint32_t) ((next_frame - now) * 1000 / SDL_GetPerformanceFrequency()));
+        else if(now - next_frame > frame_duration * FRAMERATE)
+            next_frame = now; // Too far behind to catch up
     }
 
-    save_ram(gb);
+    return 0;
 }
 
 static void handle_event(GameBoy *gb, const SDL_Event event) {
 
     switch(event.type) {
         case SDL_QUIT:
-            gb->is_running = false;
+            SDL_AtomicSet(&gb->is_running, 0);
             break;
 
         case SDL_KEYDOWN:
@@ -132,6 +187,12 @@ static void print_help() {
     printf("--serial: Output serial to terminal.\n");
     printf("--headless: Don't open a window.\n");
     printf("--info: Print cartridge info.\n");
+    printf("--colour-correction: Emulate the colours of the GameBoy Color screen.\n");
+    printf("--sample-rate <hz>: Audio output rate (default %d, up to %d).\n", SAMPLE_RATE, MAX_SAMPLE_RATE);
+    printf("--trace <file>: Record every executed instruction to a binary trace file.\n");
+    printf("--no-idle-skip: Run the loops waiting on the timer or PPU instruction by instruction.\n");
+    printf("--no-instr-cache: Decode every instruction each time it runs.\n");
+    printf("--jit: Translate the hot code to x86-64 machine code.\n");
     printf("--help: Show this help.\n");
 }
 
@@ -150,6 +211,12 @@ CliArgs parse_cli_args(const int argc, const char **argv) {
     result.should_print_serial = false;
     result.should_show_help = false;
     result.should_print_info = false;
+    result.should_correct_colours = false;
+    result.sample_rate = 0;
+    result.trace_path = NULL;
+    result.should_skip_idle_loops = true;
+    result.should_cache_instrs = true;
+    result.should_use_jit = false;
 
     if(argc < 1)
         return result;
@@ -166,6 +233,18 @@ CliArgs parse_cli_args(const int argc, const char **argv) {
                 result.is_headless = true;
             else if(strcmp(option, "info") == 0)
                 result.should_print_info = true;
+            else if(strcmp(option, "colour-correction") == 0)
+                result.should_correct_colours = true;
+            else if(strcmp(option, "sample-rate") == 0 && i + 1 < argc)
+                result.sample_rate = atoi(argv[++i]);
+            else if(strcmp(option, "trace") == 0 && i + 1 < argc)
+                result.trace_path = argv[++i];
+            else if(strcmp(option, "no-idle-skip") == 0)
+                result.should_skip_idle_loops = false;
+            else if(strcmp(option, "no-instr-cache") == 0)
+                result.should_cache_instrs = false;
+            else if(strcmp(option, "jit") == 0)
+                result.should_use_jit = true;
             else if(strcmp(option, "help") == 0)
                 result.should_show_help = true;
             else
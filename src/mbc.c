@@ -34,6 +34,7 @@ void mbc1_handler(GameBoy *gb, const uint16_t address, const uint8_t value) {
     
     // Only ram bank 0 can be used in rom mode
     if(mode == RomBanking) {
+        gb->mmu.rom00_bank = 0;
         gb->mmu.rom00 = gb->cart.rom_banks[0];
         ram_bank = 0;
     }
@@ -41,6 +42,7 @@ void mbc1_handler(GameBoy *gb, const uint16_t address, const uint8_t value) {
     else if(mode == RamBanking) {
         uint8_t eff_rom_bank = rom_bank & MBC1_ROM_RAM_CHANGE;
         eff_rom_bank %= gb->cart.rom_size;
+        gb->mmu.rom00_bank = eff_rom_bank;
         gb->mmu.rom00 = gb->cart.rom_banks[eff_rom_bank];
 
         rom_bank &= MBC1_ROM_CHANGE;
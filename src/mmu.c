@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include "jgbc.h"
 #include "macro.h"
@@ -7,13 +8,101 @@
 #include "mmu.h"
 #include "apu.h"
 #include "input.h"
+#include "timeline.h"
+#include "icache.h"
+#include "jit.h"
 
+static void map_pages(GameBoy *, uint16_t, uint16_t, PageType, uint8_t **);
 static uint8_t *get_memory(GameBoy *, uint16_t *);
 static bool is_accessible(GameBoy *, uint16_t);
+static uint8_t read_memory(GameBoy *, uint16_t, bool);
+
+static uint8_t read_io(GameBoy *, uint16_t, bool);
+static bool write_high(GameBoy *, uint16_t, uint8_t *, bool);
+static bool write_io(GameBoy *, uint16_t, uint8_t *, bool);
 
 static void sprite_DMA_transfer(GameBoy *, uint8_t);
 static void hdma_write(GameBoy *, uint16_t, uint8_t);
 
+static uint8_t read_hdma_status(const GameBoy *);
+static uint8_t read_speed(const GameBoy *);
+static bool write_serial(GameBoy *, uint16_t, uint8_t *);
+static bool write_divider(GameBoy *, uint16_t, uint8_t *);
+static bool write_timer_control(GameBoy *, uint16_t, uint8_t *);
+static bool write_interrupt_flags(GameBoy *, uint16_t, uint8_t *);
+static bool write_audio(GameBoy *, uint16_t, uint8_t *);
+static bool write_ly(GameBoy *, uint16_t, uint8_t *);
+static bool write_dma(GameBoy *, uint16_t, uint8_t *);
+static bool write_vram_bank(GameBoy *, uint16_t, uint8_t *);
+static bool write_wram_bank(GameBoy *, uint16_t, uint8_t *);
+static bool write_hdma(GameBoy *, uint16_t, uint8_t *);
+static bool write_palette_index(GameBoy *, uint16_t, uint8_t *);
+static bool write_palette_data(GameBoy *, uint16_t, uint8_t *);
+
+#define IO(address) [(address) - IO_START]
+#define UNUSED { .read_mask = 0xFF }
+#define AUDIO(mask) { .write = &write_audio, .read_mask = (mask) }
+#define COLOUR_ONLY { .is_colour_only = true }
+
+// Indexed from IO_START, the read masks are the bits that always read as 1 (CGB)
+// The CGB registers read as 0xFF and ignore the program's writes on a DMG cart
+static const IORegister io_registers[IO_SIZE] = {
+    IO(JOYP) = { .read_mask = 0xC0 },
+    IO(SB) = { .write = &write_serial },
+    IO(SC) = { .read_mask = 0x7E },
+    IO(0xFF03) = UNUSED,
+    IO(DIV) = { .read = &read_divider, .write = &write_divider },
+    IO(TAC) = { .write = &write_timer_control, .is_always_written = true, .read_mask = 0xF8 },
+    IO(0xFF08) = UNUSED, IO(0xFF09) = UNUSED, IO(0xFF0A) = UNUSED, IO(0xFF0B) = UNUSED,
+    IO(0xFF0C) = UNUSED, IO(0xFF0D) = UNUSED, IO(0xFF0E) = UNUSED,
+    IO(IF) = { .write = &write_interrupt_flags, .is_always_written = true, .read_mask = 0xE0 },
+
+    IO(NR10) = AUDIO(0x80), IO(NR11) = AUDIO(0x3F), IO(NR12) = AUDIO(0x00), IO(NR13) = AUDIO(0xFF), IO(NR14) = AUDIO(0xBF),
+    IO(NR20) = AUDIO(0xFF), IO(NR21) = AUDIO(0x3F), IO(NR22) = AUDIO(0x00), IO(NR23) = AUDIO(0xFF), IO(NR24) = AUDIO(0xBF),
+    IO(NR30) = AUDIO(0x7F), IO(NR31) = AUDIO(0xFF), IO(NR32) = AUDIO(0x9F), IO(NR33) = AUDIO(0xFF), IO(NR34) = AUDIO(0xBF),
+    IO(NR40) = AUDIO(0xFF), IO(NR41) = AUDIO(0xFF), IO(NR42) = AUDIO(0x00), IO(NR43) = AUDIO(0x00), IO(NR44) = AUDIO(0xBF),
+    IO(NR50) = AUDIO(0x00), IO(NR51) = AUDIO(0x00), IO(NR52) = AUDIO(0x70),
+    IO(0xFF27) = UNUSED, IO(0xFF28) = UNUSED, IO(0xFF29) = UNUSED, IO(0xFF2A) = UNUSED,
+    IO(0xFF2B) = UNUSED, IO(0xFF2C) = UNUSED, IO(0xFF2D) = UNUSED, IO(0xFF2E) = UNUSED, IO(0xFF2F) = UNUSED,
+
+    IO(STAT) = { .read_mask = 0x80 },
+    IO(LY) = { .write = &write_ly },
+    IO(DMA) = { .write = &write_dma },
+    IO(0xFF4C) = UNUSED,
+    IO(KEY1) = { .read = &read_speed, .read_mask = 0x7E, .is_colour_only = true },
+    IO(0xFF4E) = UNUSED,
+    IO(VBK) = { .write = &write_vram_bank, .read_mask = 0xFE, .is_colour_only = true },
+    IO(0xFF50) = UNUSED,
+    IO(HDMA1) = { .write = &write_hdma, .read_mask = 0xFF, .is_colour_only = true },
+    IO(HDMA2) = { .write = &write_hdma, .read_mask = 0xFF, .is_colour_only = true },
+    IO(HDMA3) = { .write = &write_hdma, .read_mask = 0xFF, .is_colour_only = true },
+    IO(HDMA4) = { .write = &write_hdma, .read_mask = 0xFF, .is_colour_only = true },
+    IO(HDMA5) = { .read = &read_hdma_status, .write = &write_hdma, .is_colour_only = true },
+    IO(0xFF56) = { .read_mask = 0x3C, .is_colour_only = true },
+    IO(0xFF57) = UNUSED, IO(0xFF58) = UNUSED, IO(0xFF59) = UNUSED, IO(0xFF5A) = UNUSED,
+    IO(0xFF5B) = UNUSED, IO(0xFF5C) = UNUSED, IO(0xFF5D) = UNUSED, IO(0xFF5E) = UNUSED, IO(0xFF5F) = UNUSED,
+    IO(0xFF60) = UNUSED, IO(0xFF61) = UNUSED, IO(0xFF62) = UNUSED, IO(0xFF63) = UNUSED,
+    IO(0xFF64) = UNUSED, IO(0xFF65) = UNUSED, IO(0xFF66) = UNUSED, IO(0xFF67) = UNUSED,
+    IO(BGPI) = { .write = &write_palette_index, .read_mask = 0x40, .is_colour_only = true },
+    IO(BGPD) = { .write = &write_palette_data, .is_colour_only = true },
+    IO(OBPI) = { .write = &write_palette_index, .read_mask = 0x40, .is_colour_only = true },
+    IO(OBPD) = { .write = &write_palette_data, .is_colour_only = true },
+    IO(0xFF6C) = { .read_mask = 0xFE, .is_colour_only = true },
+    IO(0xFF6D) = UNUSED, IO(0xFF6E) = UNUSED, IO(0xFF6F) = UNUSED,
+    IO(SVBK) = { .write = &write_wram_bank, .read_mask = 0xF8, .is_colour_only = true },
+    IO(0xFF71) = UNUSED,
+    IO(0xFF72) = COLOUR_ONLY, IO(0xFF73) = COLOUR_ONLY, IO(0xFF74) = COLOUR_ONLY,
+    IO(0xFF75) = { .read_mask = 0x8F, .is_colour_only = true },
+    IO(0xFF76) = COLOUR_ONLY, IO(0xFF77) = COLOUR_ONLY,
+    IO(0xFF78) = UNUSED, IO(0xFF79) = UNUSED, IO(0xFF7A) = UNUSED, IO(0xFF7B) = UNUSED,
+    IO(0xFF7C) = UNUSED, IO(0xFF7D) = UNUSED, IO(0xFF7E) = UNUSED, IO(0xFF7F) = UNUSED
+};
+
+#undef IO
+#undef UNUSED
+#undef AUDIO
+#undef COLOUR_ONLY
+
 
 void init_mmu(GameBoy *gb) {
     gb->mmu.rom00 = NULL;
@@ -24,6 +113,8 @@ void init_mmu(GameBoy *gb) {
     for(uint8_t i = 0; i < VRAM_BANK_COUNT; ++i)
         gb->mmu.vram_banks[i] = calloc(VRAM_BANK_SIZE, sizeof(uint8_t));
 
+    memset(gb->mmu.tile_versions, 0, sizeof(gb->mmu.tile_versions));
+
     gb->mmu.wram_banks = malloc(sizeof(uint8_t *) * WRAM_BANK_COUNT); 
     for(uint8_t i = 0; i < WRAM_BANK_COUNT; ++i)
         gb->mmu.wram_banks[i] = calloc(WRAM_BANK_SIZE, sizeof(uint8_t));
@@ -33,11 +124,100 @@ void init_mmu(GameBoy *gb) {
     gb->mmu.hram = calloc(HRAM_SIZE, sizeof(uint8_t));
     gb->mmu.ier = calloc(1, sizeof(uint8_t));
 
+    map_pages(gb, ROM00_START, ROMNN_END, PageROM, NULL);
+    map_pages(gb, VRAM_START, VRAM_END, PageVRAM, &gb->mmu.vram);
+    map_pages(gb, EXTRAM_START, EXTRAM_END, PageRAM, &gb->mmu.extram);
+    map_pages(gb, WRAM00_START, WRAM00_END, PageCode, &gb->mmu.wram00);
+    map_pages(gb, WRAMNN_START, WRAMNN_END, PageCode, &gb->mmu.wramNN);
+    map_pages(gb, WRAM00_MIRROR_START, WRAM00_MIRROR_END, PageCode, &gb->mmu.wram00);
+    map_pages(gb, WRAMNN_MIRROR_START, WRAMNN_MIRROR_END, PageCode, &gb->mmu.wramNN);
+    map_pages(gb, OAM_START, UNUSABLE_END, PageOAM, &gb->mmu.oam);
+    map_pages(gb, IO_START, IE_START_END, PageHigh, NULL);
+
     gb->mmu.serial_write_handler = NULL;
+
+    gb->mmu.watch.is_armed = false;
+    gb->mmu.watch.flags = calloc(UINT16_MAX + 1, sizeof(uint8_t));
+    gb->mmu.watch.handler = NULL;
+    gb->mmu.watch.data = NULL;
+
+    gb->mmu.writes.is_enabled = false;
+    gb->mmu.writes.changed = NULL;
+    clear_write_counts(gb);
+}
+
+// The pages of a region all point to its bank pointer, a region without one goes through get_memory
+static void map_pages(GameBoy *gb, const uint16_t start, const uint16_t end, const PageType type, uint8_t **region) {
+
+    for(uint32_t address = start; address <= end; address += 0x100) {
+        MemoryPage *page = &gb->mmu.pages[address >> 8];
+
+        page->type = type;
+        page->region = region;
+        page->offset = address - start;
+    }
+}
+
+// The handler is called with the address, the value read or written and whether it was a write
+// Accesses are only checked once watchpoints are armed (watch.is_armed) and flagged (watch.flags)
+void set_watch_handler(GameBoy *gb, void (*handler)(void *, uint16_t, uint8_t, bool), void *data) {
+    gb->mmu.watch.handler = handler;
+    gb->mmu.watch.data = data;
+}
+
+// Bank mapped at an address for the regions that can be switched, 0 elsewhere
+uint16_t mapped_bank(const GameBoy *gb, const uint16_t address) {
+
+    if(address >= ROMNN_START && address <= ROMNN_END)
+        return gb->mmu.rom_bank;
+
+    if(address >= VRAM_START && address <= VRAM_END)
+        return gb->mmu.vram_bank;
+
+    if(address >= EXTRAM_START && address <= EXTRAM_END)
+        return gb->mmu.ram_bank;
+
+    if((address >= WRAMNN_START && address <= WRAMNN_END) || (address >= WRAMNN_MIRROR_START && address <= WRAMNN_MIRROR_END))
+        return gb->mmu.wram_bank;
+
+    return 0;
+}
+
+// The bitmap is allocated the first time tracking starts
+void start_write_tracking(GameBoy *gb) {
+
+    if(gb->mmu.writes.changed == NULL)
+        gb->mmu.writes.changed = calloc((UINT16_MAX + 1) / 8, sizeof(uint8_t));
+
+    gb->mmu.writes.is_enabled = true;
+}
+
+void stop_write_tracking(GameBoy *gb) {
+    gb->mmu.writes.is_enabled = false;
+}
+
+void clear_changed_bytes(GameBoy *gb) {
+    if(gb->mmu.writes.changed != NULL)
+        memset(gb->mmu.writes.changed, 0, (UINT16_MAX + 1) / 8);
+}
+
+void clear_write_counts(GameBoy *gb) {
+    memset(gb->mmu.writes.page_counts, 0, sizeof(gb->mmu.writes.page_counts));
+}
+
+// Whether a write changed the byte at an address since the last clear
+bool is_byte_changed(const GameBoy *gb, const uint16_t address) {
+
+    if(gb->mmu.writes.changed == NULL)
+        return false;
+
+    return (gb->mmu.writes.changed[address / 8] >> (address % 8)) & 1;
 }
 
 void reset_mmu(GameBoy *gb) {
 
+    gb->mmu.vram_bank = 0;
+    gb->mmu.wram_bank = 1;
     gb->mmu.vram = gb->mmu.vram_banks[0];
     gb->mmu.wram00 = gb->mmu.wram_banks[0];
     gb->mmu.wramNN = gb->mmu.wram_banks[1];
@@ -125,24 +305,45 @@ static bool is_accessible(GameBoy *gb, const uint16_t address) {
     return true;
 }
 
-uint8_t read_byte(GameBoy *gb, uint16_t address, const bool is_program) {
+uint8_t read_byte(GameBoy *gb, const uint16_t address, const bool is_program) {
 
-    if(is_program && address == JOYP)
-        return joypad_state(gb);
+    const uint8_t data = read_memory(gb, address, is_program);
+
+    if(gb->mmu.watch.is_armed && is_program && (gb->mmu.watch.flags[address] & WATCH_READ))
+        gb->mmu.watch.handler(gb->mmu.watch.data, address, data, false);
+
+    return data;
+}
+
+static uint8_t read_memory(GameBoy *gb, uint16_t address, const bool is_program) {
 
     if(!is_accessible(gb, address))
         return 0xFF;
 
-    if(address == HDMA5)
-        return (!gb->mmu.hdma.is_active << 7) | (0x1F);
+    if(address >= IO_START && address <= IO_END)
+        return read_io(gb, address, is_program);
+
+    const uint8_t *mem = get_memory(gb, &address);
+    return mem[address];
+}
 
-    uint8_t *mem = get_memory(gb, &address);
-    uint8_t data = mem[address];
+static uint8_t read_io(GameBoy *gb, const uint16_t address, const bool is_program) {
 
-    if(address == KEY1)
-        data = (data & 0x7F) | (gb->cpu.is_double_speed << 7);
+    const IORegister *reg = &io_registers[address - IO_START];
+    uint8_t data;
 
-    return data;
+    if(is_program && reg->is_colour_only && !gb->cart.is_colour)
+        return 0xFF;
+
+    // The joypad reads the selection bits back from the register itself
+    if(is_program && address == JOYP)
+        data = joypad_state(gb);
+    else if(reg->read != NULL)
+        data = reg->read(gb);
+    else
+        data = gb->mmu.io[address - IO_START];
+
+    return is_program ? data | reg->read_mask : data;
 }
 
 uint16_t read_short(GameBoy *gb, const uint16_t address, const bool is_program) {
@@ -154,62 +355,108 @@ uint16_t read_short(GameBoy *gb, const uint16_t address, const bool is_program)
 
 void write_byte(GameBoy *gb, uint16_t address, uint8_t value, const bool is_program) {
 
-    if(address <= ROMNN_END) {
-        if(gb->mmu.mbc_handler != NULL)
-            gb->mmu.mbc_handler(gb, address, value);
+    if(gb->mmu.watch.is_armed && is_program && (gb->mmu.watch.flags[address] & WATCH_WRITE))
+        gb->mmu.watch.handler(gb->mmu.watch.data, address, value, true);
 
-        return;
-    }
+    const MemoryPage *page = &gb->mmu.pages[address >> 8];
 
-    if(!is_accessible(gb, address))
-        return;
+    switch(page->type) {
 
-    if(is_program) {
+        case PageROM:
+            if(gb->mmu.mbc_handler != NULL)
+                gb->mmu.mbc_handler(gb, address, value);
 
-        if(address == SB && gb->mmu.serial_write_handler != NULL) {
-            gb->mmu.serial_write_handler(value);
-            return;
-        }
-    
-        if(address == DMA) {
-            sprite_DMA_transfer(gb, value);
             return;
-        }
-    
-        if(address == DIV) {
-            gb->cpu.div_clock = 0;
-            gb->cpu.cnt_clock = 0;
 
-            value = 0x0;
-        }
+        case PageVRAM:
+            if(address <= VRAM_TILE_DATA_END)
+                gb->mmu.tile_versions[gb->mmu.vram_bank][(address - VRAM_START) / VRAM_TILE_SIZE]++;
 
-        if(address == LY)
-            value = 0x0;
+            break;
 
-        if(address >= NR10 && address <= NR52)
-            audio_register_write(gb, address, value);
+        case PageCode:
+            invalidate_instr(gb, address);
+            invalidate_blocks(gb, address);
+            break;
 
-        if(address == VBK) {
-            const uint8_t bank = GET_BIT(value, VBK_BANK);
+        case PageOAM:
+            if(address > OAM_END)
+                return;
 
-            gb->mmu.vram_bank = bank;
-            gb->mmu.vram = gb->mmu.vram_banks[bank];
-        }
+            gb->ppu.is_sprite_buffer_dirty = true;
+            break;
 
-        if(address == BGPI || address == OBPI)
-            palette_index_write(gb, address, value);
+        case PageHigh:
+            if(!write_high(gb, address, &value, is_program))
+                return;
 
-        if(address == BGPD || address == OBPD)
-            palette_data_write(gb, address, value);
+            break;
 
-        if(address >= HDMA1 && address <= HDMA5)
-            hdma_write(gb, address, value);
+        case PageRAM:
+            break;
+    }
+
+    const uint16_t cpu_address = address;
+    uint8_t *mem;
+
+    if(page->region != NULL) {
+        mem = *page->region;
+        address = page->offset + (address & 0xFF);
+    }
+    else
+        mem = get_memory(gb, &address);
+
+    // No cartridge RAM mapped
+    if(mem == NULL)
+        return;
+
+    if(gb->mmu.writes.is_enabled) {
+        gb->mmu.writes.page_counts[cpu_address / WRITE_PAGE_SIZE]++;
+
+        if(mem[address] != value)
+            gb->mmu.writes.changed[cpu_address / 8] |= 1 << (cpu_address % 8);
     }
 
-    uint8_t *mem = get_memory(gb, &address);
     mem[address] = value;
 }
 
+// IO registers, high RAM and IE share the last page
+// Returns false if the value isn't stored
+static bool write_high(GameBoy *gb, const uint16_t address, uint8_t *value, const bool is_program) {
+
+    if(address <= IO_END)
+        return write_io(gb, address, value, is_program);
+
+    if(address == IE_START_END) {
+        if(is_program && gb->timeline.is_enabled)
+            log_event(gb, EventRegisterWrite, address, *value);
+
+        gb->cpu.pending_interrupts = *value & gb->mmu.io[IF - IO_START] & 0x1F;
+    }
+
+    // Code can run from the high RAM, an instruction at its end reads IE
+    invalidate_instr(gb, address);
+    invalidate_blocks(gb, address);
+    return true;
+}
+
+// Returns false if the value isn't stored
+static bool write_io(GameBoy *gb, const uint16_t address, uint8_t *value, const bool is_program) {
+
+    const IORegister *reg = &io_registers[address - IO_START];
+
+    if(is_program && gb->timeline.is_enabled)
+        log_event(gb, EventRegisterWrite, address, *value);
+
+    if(is_program && reg->is_colour_only && !gb->cart.is_colour)
+        return false;
+
+    if(reg->write == NULL || !(is_program || reg->is_always_written))
+        return true;
+
+    return reg->write(gb, address, value);
+}
+
 void write_short(GameBoy *gb, const uint16_t address, const uint16_t value, const bool is_program) {
     const uint8_t byte_a = (value & 0x00FF);
     const uint8_t byte_b = (value & 0xFF00) >> 8;
@@ -234,10 +481,11 @@ static void sprite_DMA_transfer(GameBoy *gb, const uint8_t value) {
     // TODO: emulate timing
     const uint16_t address = value * 0x100;
 
+    if(gb->timeline.is_enabled)
+        log_event(gb, EventDMA, address, 0xA0);
+
     for(uint8_t i = 0; i <= 0x9F; ++i)
         SWRITE8(0xFE00 + i, SREAD8(address + i));
-
-    get_sprites(gb);
 }
 
 void update_hdma(GameBoy *gb) {
@@ -245,6 +493,9 @@ void update_hdma(GameBoy *gb) {
     if(!gb->mmu.hdma.is_active)
         return;
 
+    if(gb->timeline.is_enabled)
+        log_event(gb, EventHDMA, gb->mmu.hdma.source_addr, gb->mmu.hdma.length);
+
     for(uint8_t i = 0; i < gb->mmu.hdma.length; ++i) {
         SWRITE8(gb->mmu.hdma.dest_addr + i, SREAD8(gb->mmu.hdma.source_addr + i));
     }
@@ -285,3 +536,110 @@ static void hdma_write(GameBoy *gb, const uint16_t addr, const uint8_t value) {
             ASSERT_NOT_REACHED();
     }
 }
+
+/*
+    IO Register Handlers
+*/
+
+static uint8_t read_hdma_status(const GameBoy *gb) {
+    return (!gb->mmu.hdma.is_active << 7) | 0x1F;
+}
+
+static uint8_t read_speed(const GameBoy *gb) {
+    return (gb->mmu.io[KEY1 - IO_START] & 0x7F) | (gb->cpu.is_double_speed << 7);
+}
+
+static bool write_serial(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) address;
+
+    if(gb->mmu.serial_write_handler == NULL)
+        return true;
+
+    gb->mmu.serial_write_handler(*value);
+    return false;
+}
+
+static bool write_divider(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) address;
+
+    reset_divider(gb);
+    *value = 0;
+
+    return true;
+}
+
+static bool write_timer_control(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) address;
+
+    set_timer_control(gb, *value);
+    return true;
+}
+
+static bool write_interrupt_flags(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) address;
+
+    gb->cpu.pending_interrupts = *gb->mmu.ier & *value & 0x1F;
+    return true;
+}
+
+static bool write_audio(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    audio_register_write(gb, address, *value);
+    return true;
+}
+
+static bool write_ly(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) gb;
+    (void) address;
+
+    *value = 0;
+    return true;
+}
+
+static bool write_dma(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) address;
+
+    sprite_DMA_transfer(gb, *value);
+    return false;
+}
+
+static bool write_vram_bank(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) address;
+
+    const uint8_t bank = GET_BIT(*value, VBK_BANK);
+
+    gb->mmu.vram_bank = bank;
+    gb->mmu.vram = gb->mmu.vram_banks[bank];
+
+    return true;
+}
+
+// The pages of D000 and its echo point to wramNN, they follow the bank without being remapped
+static bool write_wram_bank(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    (void) address;
+
+    if(!gb->cart.is_colour)
+        return true;
+
+    // Bank 0 selects bank 1
+    const uint8_t bank = *value & SVBK_BANK;
+
+    gb->mmu.wram_bank = (bank == 0) ? 1 : bank;
+    gb->mmu.wramNN = gb->mmu.wram_banks[gb->mmu.wram_bank];
+
+    return true;
+}
+
+static bool write_hdma(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    hdma_write(gb, address, *value);
+    return true;
+}
+
+static bool write_palette_index(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    palette_index_write(gb, address, *value);
+    return true;
+}
+
+static bool write_palette_data(GameBoy *gb, const uint16_t address, uint8_t *value) {
+    palette_data_write(gb, address, *value);
+    return true;
+}
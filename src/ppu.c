@@ -6,42 +6,67 @@
 #include "mmu.h"
 #include "cpu.h"
 #include "ppu.h"
+#include "tile.h"
+#include "timeline.h"
 
 static void update_render_mode(GameBoy *, uint8_t, bool);
+static PPUMode render_mode(const GameBoy *, uint8_t, bool);
+static void publish_frame(GameBoy *);
 
 static bool get_bg_tile_data_start(GameBoy *, uint16_t *);
 static uint16_t get_tile_map_offset(Position);
 static uint16_t get_tile_data_offset(GameBoy *gb, uint16_t, bool);
 static void get_tile_row_data(GameBoy *gb, uint8_t, uint8_t, uint16_t, uint8_t *);
-static uint16_t get_tile_pixel(Position, const uint8_t *, bool, const uint16_t *);
 static TileAttributes get_tile_attributes(GameBoy *, uint16_t);
-static void plot_tile_pixel(uint16_t *, Position, uint16_t);
 
+static void render_tile_scan(GameBoy *, uint16_t, Position, uint8_t, uint8_t, bool, const uint32_t *);
 static void render_bg_scan(GameBoy *, uint8_t);
 static void render_window_scan(GameBoy *, uint8_t);
 static void render_sprite_scan(GameBoy *, uint8_t);
 
 static int sprite_cmp(const void *, const void *);
 static uint16_t get_shade(uint8_t);
-static void fill_shade_table(uint8_t, uint16_t *);
+static void fill_shade_table(GameBoy *, uint8_t, uint32_t *);
+
+static uint32_t convert_colour(GameBoy *, uint16_t);
+static void update_colour_tables(GameBoy *);
 
 
 void init_ppu(GameBoy *gb) {
-    gb->ppu.framebuffer = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t));
+    FrameQueue *frames = malloc(sizeof(FrameQueue));
+
+    for(uint8_t i = 0; i < FRAMEBUFFER_COUNT; ++i)
+        frames->buffers[i] = calloc(SCREEN_WIDTH * SCREEN_HEIGHT, sizeof(uint32_t));
+
+    frames->back = 0;
+    frames->front = 1;
+    SDL_AtomicSet(&frames->ready, 2);
+
+    gb->ppu.frames = frames;
+    gb->ppu.framebuffer = frames->buffers[frames->back];
+
+    gb->ppu.is_colour_corrected = false;
 
     gb->ppu.window = NULL;
     gb->ppu.renderer = NULL;
     gb->ppu.texture = NULL;
+
+    set_tile_decoder(gb);
 }
 
 void reset_ppu(GameBoy *gb) {
     gb->ppu.scan_clock = 0;
     gb->ppu.frame_clock = 0;
 
-    memset(gb->ppu.framebuffer, 0, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(int16_t));
+    // Only the frame being drawn belongs to this thread, the others may be in use by the presenting thread
+    memset(gb->ppu.framebuffer, 0, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
+
     memset(gb->ppu.sprite_buffer, 0, 40 * sizeof(Sprite));
+    gb->ppu.is_sprite_buffer_dirty = true;
     memset(gb->ppu.bg_palette, 0, 32 * sizeof(uint16_t));
     memset(gb->ppu.obj_palette, 0, 32 * sizeof(uint16_t));
+
+    update_colour_tables(gb);
 }
 
 void init_window(GameBoy *gb) {
@@ -70,14 +95,21 @@ void init_window(GameBoy *gb) {
 
     gb->ppu.texture = SDL_CreateTexture(
         gb->ppu.renderer,
-        SDL_PIXELFORMAT_ABGR1555,
+        SDL_PIXELFORMAT_ABGR8888,
         SDL_TEXTUREACCESS_STREAMING,
         SCREEN_WIDTH,
         SCREEN_HEIGHT
     );
 }
 
-void render(GameBoy *gb) {
+// Presents the last completed frame, returns false if there was no new frame
+// Must be called from the thread that owns the window
+bool render(GameBoy *gb) {
+
+    const uint32_t *frame = take_frame(gb);
+
+    if(frame == NULL)
+        return false;
 
     SDL_SetRenderDrawColor(gb->ppu.renderer, 0, 0, 0, 255);
     SDL_RenderClear(gb->ppu.renderer);
@@ -85,12 +117,47 @@ void render(GameBoy *gb) {
     SDL_UpdateTexture(
         gb->ppu.texture,
         NULL,
-        gb->ppu.framebuffer,
-        SCREEN_WIDTH * sizeof(uint16_t)
+        frame,
+        SCREEN_WIDTH * sizeof(uint32_t)
     );
 
     SDL_RenderCopy(gb->ppu.renderer, gb->ppu.texture, NULL, NULL);
     SDL_RenderPresent(gb->ppu.renderer);
+
+    return true;
+}
+
+// Swaps the completed back buffer into the ready slot
+static void publish_frame(GameBoy *gb) {
+
+    FrameQueue *frames = gb->ppu.frames;
+    const uint32_t *completed = gb->ppu.framebuffer;
+
+    SDL_MemoryBarrierRelease();
+    const int ready = SDL_AtomicSet(&frames->ready, frames->back | FRAME_READY);
+
+    frames->back = ready & ~FRAME_READY;
+    gb->ppu.framebuffer = frames->buffers[frames->back];
+
+    // Lines that aren't drawn (background disabled) keep showing the previous frame
+    memcpy(gb->ppu.framebuffer, completed, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
+}
+
+// Takes ownership of the last completed frame, or returns NULL if it has already been taken
+// The frame stays valid until the next call
+const uint32_t *take_frame(GameBoy *gb) {
+
+    FrameQueue *frames = gb->ppu.frames;
+
+    if(!(SDL_AtomicGet(&frames->ready) & FRAME_READY))
+        return NULL;
+
+    SDL_MemoryBarrierRelease();
+    const int ready = SDL_AtomicSet(&frames->ready, frames->front);
+    SDL_MemoryBarrierAcquire();
+
+    frames->front = ready & ~FRAME_READY;
+    return frames->buffers[frames->front];
 }
 
 void update_ppu(GameBoy *gb) {
@@ -123,9 +190,10 @@ void update_ppu(GameBoy *gb) {
         // End of frame, request vblank interrupt
         else if(ly == 144) {
             WREG(IF, IEF_VBLANK, 1);
+            publish_frame(gb);
 
-            if(gb->ppu.window != NULL)
-                render(gb);
+            if(gb->timeline.is_enabled)
+                end_timeline_frame(gb);
         }
 
         // Check if LY == LYC
@@ -142,38 +210,51 @@ void update_ppu(GameBoy *gb) {
     }
 }
 
+// T-cycles until update_ppu next has something to do other than moving the scan clock forward
+// The mode is updated at the start of a step, the step that changes it is a single one
+uint16_t next_ppu_event(GameBoy *gb) {
+
+    const bool lcd_on = RREG(LCDC, LCDC_LCD_ENABLE);
+    const PPUMode mode = render_mode(gb, SREAD8(LY), lcd_on);
+
+    if(mode != (SREAD8(STAT) & 0x3))
+        return CPU_STEP;
+
+    // Stays in V-Blank on line 0 until the LCD is turned on
+    if(!lcd_on)
+        return UINT16_MAX;
+
+    uint16_t end = CLOCKS_PER_SCANLINE;
+
+    if(mode == OamTransfer)
+        end = PIXEL_TRANSFER_START;
+    else if(mode == PixelTransfer)
+        end = HBLANK_START;
+
+    // The last step reaches the end
+    const uint16_t ticks = end - gb->ppu.scan_clock;
+    return (ticks + CPU_STEP - 1) / CPU_STEP * CPU_STEP;
+}
+
 // Updates the mode in the STAT register based on the ly and scan clock 
 static void update_render_mode(GameBoy *gb, const uint8_t ly, const bool lcd_on) {
     
     const uint8_t curr_mode = SREAD8(STAT) & 0x3;
-    PPUMode new_mode = -1;
-    bool request_int = false;
+    const PPUMode new_mode = render_mode(gb, ly, lcd_on);
 
-    // V-Blank (10 lines)
-    if(ly >= 144 || !lcd_on) {
-        new_mode = VBlank;
-        request_int = RREG(STAT, STAT_VBLANK_INT);
-    }
-    // Screen rendering (144 lines aka height of screen in px)
-    else {
-    
-        // OAM Transfer
-        if(gb->ppu.scan_clock < 80) {
-            new_mode = OamTransfer;
-            request_int = RREG(STAT, STAT_OAM_INT);
-        }
-        // Pixel Transfer
-        else if(gb->ppu.scan_clock >= 80 && gb->ppu.scan_clock <= 252) {
-            new_mode = PixelTransfer;
-        } 
-        // H-Blank
-        else if(gb->ppu.scan_clock > 252) {
-            new_mode = HBlank; 
-            request_int = RREG(STAT, STAT_HBLANK_INT);
+    if(new_mode != curr_mode) {
+
+        bool request_int = false;
+
+        switch(new_mode) {
+            case VBlank: request_int = RREG(STAT, STAT_VBLANK_INT); break;
+            case OamTransfer: request_int = RREG(STAT, STAT_OAM_INT); break;
+            case HBlank: request_int = RREG(STAT, STAT_HBLANK_INT); break;
+            default: break;
         }
-    }
 
-    if(new_mode != curr_mode) {
+        if(gb->timeline.is_enabled)
+            log_event(gb, EventModeChange, STAT, new_mode);
 
         // We've changed mode and the interrupt for this mode is active
         // So request a LCD STAT interrupt
@@ -185,6 +266,23 @@ static void update_render_mode(GameBoy *gb, const uint8_t ly, const bool lcd_on)
     }
 }
 
+// Mode of the PPU for the ly and scan clock
+static PPUMode render_mode(const GameBoy *gb, const uint8_t ly, const bool lcd_on) {
+
+    // V-Blank (10 lines)
+    if(ly >= 144 || !lcd_on)
+        return VBlank;
+
+    // Screen rendering (144 lines aka height of screen in px)
+    if(gb->ppu.scan_clock < PIXEL_TRANSFER_START)
+        return OamTransfer;
+
+    if(gb->ppu.scan_clock < HBLANK_START)
+        return PixelTransfer;
+
+    return HBlank;
+}
+
 // Get the start of the tile data for background and window tiles
 // Returns true if the tile number is a signed integer
 static bool get_bg_tile_data_start(GameBoy *gb, uint16_t *start) {
@@ -230,17 +328,6 @@ static void get_tile_row_data(GameBoy *gb, const uint8_t line, const uint8_t vra
     data[1] = vram[data_addr + tile_y + 1 - VRAM_START];
 }
 
-// Get the colour of a pixel in a tile
-static uint16_t get_tile_pixel(Position screen_pos, const uint8_t *data, const bool is_flipped_x, const uint16_t *palette) {
-
-    const uint8_t bit = is_flipped_x
-        ? screen_pos.x % 8
-        : 7 - screen_pos.x % 8;
-    
-    const uint8_t colour_num = GET_BIT(data[0], bit) | (GET_BIT(data[1], bit) << 1);
-    return palette[colour_num];
-}
-
 // Gets the tile attributes for a given tile (CGB only)
 static TileAttributes get_tile_attributes(GameBoy *gb, const uint16_t map_addr) {
 
@@ -258,67 +345,83 @@ static TileAttributes get_tile_attributes(GameBoy *gb, const uint16_t map_addr)
     return result;
 }
 
-// Plots a single grayscale pixel on the screen at the given coordinate
-static void plot_tile_pixel(uint16_t *framebuffer, const Position display_pos, const uint16_t colour) {
+// Renders a run of background or window tiles on a scanline
+// The tiles are fetched once per 8 pixels and decoded a whole row at a time
+static void render_tile_scan(GameBoy *gb, const uint16_t map_start, const Position map_pos, const uint8_t display_x, const uint8_t ly, const bool has_attributes, const uint32_t *shades) {
 
-    const uint16_t buf_offset = display_pos.x + display_pos.y * SCREEN_WIDTH;
-    framebuffer[buf_offset] = colour;
-}
+    uint16_t data_start;
+    const bool signed_tile_num = get_bg_tile_data_start(gb, &data_start);
 
-static void render_bg_scan(GameBoy *gb, const uint8_t ly) {
+    // The first tile can be partially scrolled off the left of the screen
+    const uint8_t fine_x = map_pos.x % TILE_WIDTH;
+    const uint8_t width = SCREEN_WIDTH - display_x;
+    const uint8_t tile_count = (fine_x + width + TILE_WIDTH - 1) / TILE_WIDTH;
 
-    if(!RREG(LCDC, LCDC_BG_DISPLAY))
-        return;
+    TileRow rows[SCREEN_WIDTH / TILE_WIDTH + 1];
 
-    const uint16_t map_start = (RREG(LCDC, LCDC_BG_TILE_MAP) ? 0x9C00 : 0x9800);
+    for(uint8_t i = 0; i < tile_count; ++i) {
 
-    uint16_t data_start = 0;
-    const bool signed_tile_num = get_bg_tile_data_start(gb, &data_start);
+        // Position in screen memory of this tile
+        const Position tile_pos = {
+            map_pos.x + i * TILE_WIDTH,
+            map_pos.y
+        };
 
-    const uint8_t scroll_x = SREAD8(SCX);
-    const uint8_t scroll_y = SREAD8(SCY);
+        const uint16_t map_addr = map_start + get_tile_map_offset(tile_pos);
+        const uint16_t data_addr = data_start + get_tile_data_offset(gb, map_addr, signed_tile_num);
 
-    uint16_t colours[4];
-    const uint8_t palette = SREAD8(BGP);
-    fill_shade_table(palette, colours);
+        TileAttributes attributes = { 0, 0, false, false, false };
+        const uint32_t *palette = shades;
 
-    // TODO: optimise: only fetch attributes and data once per 8 pixels
-    // TODO: merge bg and window code somehow
-    for(uint8_t scan_x = 0; scan_x < SCREEN_WIDTH; scan_x++) {
+        if(has_attributes) {
+            attributes = get_tile_attributes(gb, map_addr);
 
-        // Position in screen memory after scrolling
-        const Position screen_pos = { 
-            scroll_x + scan_x, 
-            scroll_y + ly 
-        };
+            if(gb->cart.is_colour)
+                palette = &gb->ppu.bg_colours[attributes.palette * 4];
+        }
 
-        const uint16_t map_offset = get_tile_map_offset(screen_pos);
-        const uint16_t map_addr = map_start + map_offset;
-        const TileAttributes attributes = get_tile_attributes(gb, map_addr);
+        const uint8_t line = attributes.is_flipped_y
+            ? 7 - tile_pos.y % 8
+            : tile_pos.y % 8;
 
-        if(gb->cart.is_colour) {
+        uint8_t data[2];
+        get_tile_row_data(gb, line, attributes.vram_bank, data_addr, data);
 
-            for(uint8_t i = 0; i < 4; ++i)
-                colours[i] = gb->ppu.bg_palette[attributes.palette * 4 + i];
+        if(attributes.is_flipped_x) {
+            data[0] = reverse_tile_byte(data[0]);
+            data[1] = reverse_tile_byte(data[1]);
         }
 
-        const uint16_t data_addr = data_start + get_tile_data_offset(gb, map_addr, signed_tile_num);
+        rows[i].low = data[0];
+        rows[i].high = data[1];
+        rows[i].palette = palette;
+    }
 
-        uint8_t data[2];
+    uint32_t line_buffer[(SCREEN_WIDTH / TILE_WIDTH + 1) * TILE_WIDTH];
+    gb->ppu.tile_decoder(rows, tile_count, line_buffer);
 
-        const uint8_t line = attributes.is_flipped_y
-            ? 7 - screen_pos.y % 8
-            : screen_pos.y % 8;
+    uint32_t *framebuffer = &gb->ppu.framebuffer[display_x + ly * SCREEN_WIDTH];
+    memcpy(framebuffer, &line_buffer[fine_x], width * sizeof(uint32_t));
+}
 
-        get_tile_row_data(gb, line, attributes.vram_bank, data_addr, data);
+static void render_bg_scan(GameBoy *gb, const uint8_t ly) {
 
-        const uint16_t colour = get_tile_pixel(screen_pos, data, attributes.is_flipped_x, colours);
+    if(!RREG(LCDC, LCDC_BG_DISPLAY))
+        return;
 
-        // Position on the physical display
-        const Position display_pos = { scan_x, ly };
+    const uint16_t map_start = (RREG(LCDC, LCDC_BG_TILE_MAP) ? 0x9C00 : 0x9800);
 
-        plot_tile_pixel(gb->ppu.framebuffer, display_pos, colour);
-    }
+    uint32_t shades[4];
+    const uint8_t palette = SREAD8(BGP);
+    fill_shade_table(gb, palette, shades);
+
+    // Position in screen memory after scrolling
+    const Position map_pos = {
+        SREAD8(SCX),
+        SREAD8(SCY) + ly
+    };
+
+    render_tile_scan(gb, map_start, map_pos, 0, ly, true, shades);
 }
 
 static void render_window_scan(GameBoy *gb, const uint8_t ly) {
@@ -328,44 +431,23 @@ static void render_window_scan(GameBoy *gb, const uint8_t ly) {
 
     const uint16_t map_start = (RREG(LCDC, LCDC_WINDOW_TILE_MAP) ? 0x9C00 : 0x9800);
 
-    uint16_t data_start;
-    const bool signed_tile_num = get_bg_tile_data_start(gb, &data_start);
-
-    uint16_t colours[4];
+    uint32_t shades[4];
     const uint8_t palette = SREAD8(BGP);
-    fill_shade_table(palette, colours);
+    fill_shade_table(gb, palette, shades);
 
     const uint8_t window_x = SREAD8(WX) - 7;
     const uint8_t window_y = SREAD8(WY);
 
-    for(uint8_t scan_x = 0; scan_x < SCREEN_WIDTH; scan_x++) {
-
-        if(ly < window_y)
-            return; 
-
-        if(scan_x < window_x)
-            continue; 
-
-        // Position in screen memory after scrolling
-        const Position screen_pos = { 
-            window_x + scan_x,
-            ly - window_y
-        };
-
-        const uint16_t map_addr = map_start + get_tile_map_offset(screen_pos);
-        const uint16_t data_addr = data_start + get_tile_data_offset(gb, map_addr, signed_tile_num);
-
-        uint8_t data[2];
-        const uint8_t line = screen_pos.y % 8;
-        get_tile_row_data(gb, line, 0, data_addr, data);
-
-        const uint16_t colour = get_tile_pixel(screen_pos, data, false, colours);
+    if(ly < window_y || window_x >= SCREEN_WIDTH)
+        return;
 
-        // Position on the physical display
-        const Position display_pos = { scan_x, ly };
+    // The window map always starts at its first column, only its position on the screen moves
+    const Position map_pos = {
+        0,
+        ly - window_y
+    };
 
-        plot_tile_pixel(gb->ppu.framebuffer, display_pos, colour);
-    }
+    render_tile_scan(gb, map_start, map_pos, window_x, ly, false, shades);
 }
 
 static void render_sprite_scan(GameBoy *gb, const uint8_t ly) {
@@ -373,6 +455,9 @@ static void render_sprite_scan(GameBoy *gb, const uint8_t ly) {
     if(!RREG(LCDC, LCDC_OBJ_DISPLAY))
         return;
 
+    if(gb->ppu.is_sprite_buffer_dirty)
+        get_sprites(gb);
+
     const bool tall_sprites = RREG(LCDC, LCDC_OBJ_SIZE);
     const uint8_t height = (tall_sprites) ? 16 : 8;
 
@@ -387,8 +472,8 @@ static void render_sprite_scan(GameBoy *gb, const uint8_t ly) {
             const uint16_t palette_addr = (GET_BIT(sprite.attributes, SPRITE_ATTR_PALETTE)) ? OBP1 : OBP0;
             const uint8_t palette = SREAD8(palette_addr);
 
-            uint16_t shades[4];
-            fill_shade_table(palette, shades);
+            uint32_t shades[4];
+            fill_shade_table(gb, palette, shades);
 
             // A tall sprite has the first bit removed 
             const uint8_t tile = (tall_sprites) ? sprite.tile & 0x7F : sprite.tile;
@@ -421,11 +506,11 @@ static void render_sprite_scan(GameBoy *gb, const uint8_t ly) {
                 if(shade_num == 0)
                     continue; 
                 
-                const uint16_t shade = shades[shade_num];
+                const uint32_t shade = shades[shade_num];
                 const uint32_t buf_offset = (x + px) + (ly * SCREEN_WIDTH);
 
                 // If the sprite is behind the background, it is only visible above white
-                if(is_behind_bg && gb->ppu.framebuffer[buf_offset] != WHITE)
+                if(is_behind_bg && gb->ppu.framebuffer[buf_offset] != gb->ppu.shades[0])
                     continue; 
 
                 gb->ppu.framebuffer[buf_offset] = shade;
@@ -456,6 +541,7 @@ void get_sprites(GameBoy *gb) {
     }
 
     qsort(gb->ppu.sprite_buffer, 40, sizeof(Sprite), sprite_cmp);
+    gb->ppu.is_sprite_buffer_dirty = false;
 }
 
 // Returns the colour associated with a shade number tiles
@@ -478,14 +564,58 @@ static uint16_t get_shade(const uint8_t num) {
 
 // Modifies a table to add the color shades for bg tiles according to the palette register provided
 // Monochrome GameBoy only
-static void fill_shade_table(const uint8_t palette, uint16_t *colours) {
+static void fill_shade_table(GameBoy *gb, const uint8_t palette, uint32_t *colours) {
     uint8_t i = 0;
     uint8_t j = 0;
 
     for(; i < 8; i += 2, j++) {
         const uint8_t shade_num = (GET_BIT(palette, i + 1) << 1) | GET_BIT(palette, i);
-        colours[j] = get_shade(shade_num);
+        colours[j] = gb->ppu.shades[shade_num];
+    }
+}
+
+// Converts a BGR555 colour to the framebuffer format
+// The colour correction approximates the washed out colours of the CGB screen
+static uint32_t convert_colour(GameBoy *gb, const uint16_t colour) {
+
+    const uint32_t red = colour & 0x1F;
+    const uint32_t green = (colour >> 5) & 0x1F;
+    const uint32_t blue = (colour >> 10) & 0x1F;
+
+    uint32_t r, g, b;
+
+    if(gb->ppu.is_colour_corrected) {
+        r = red * 26 + green * 4 + blue * 2;
+        g = green * 24 + blue * 8;
+        b = red * 6 + green * 4 + blue * 22;
+
+        r = (r > 960 ? 960 : r) >> 2;
+        g = (g > 960 ? 960 : g) >> 2;
+        b = (b > 960 ? 960 : b) >> 2;
+    } else {
+        r = (red << 3) | (red >> 2);
+        g = (green << 3) | (green >> 2);
+        b = (blue << 3) | (blue >> 2);
     }
+
+    return 0xFF000000 | (b << 16) | (g << 8) | r;
+}
+
+// Reconverts every palette entry, only needed when the conversion itself changes
+static void update_colour_tables(GameBoy *gb) {
+
+    for(uint8_t i = 0; i < 32; ++i) {
+        gb->ppu.bg_colours[i] = convert_colour(gb, gb->ppu.bg_palette[i]);
+        gb->ppu.obj_colours[i] = convert_colour(gb, gb->ppu.obj_palette[i]);
+    }
+
+    for(uint8_t i = 0; i < 4; ++i)
+        gb->ppu.shades[i] = convert_colour(gb, get_shade(i));
+}
+
+void set_colour_correction(GameBoy *gb, const bool is_enabled) {
+    gb->ppu.is_colour_corrected = is_enabled;
+    update_colour_tables(gb);
 }
 
 void palette_index_write(GameBoy *gb, const uint16_t address, const uint8_t value) {
@@ -525,13 +655,16 @@ void palette_data_write(GameBoy *gb, const uint16_t address, const uint8_t value
     assert(address == BGPD || address == OBPD);
 
     uint16_t *palette = NULL;
+    uint32_t *colours = NULL;
     uint16_t index_reg_addr;
 
     if(address == BGPD) {
         palette = gb->ppu.bg_palette;
+        colours = gb->ppu.bg_colours;
         index_reg_addr = BGPI;
     } else {
         palette = gb->ppu.obj_palette;
+        colours = gb->ppu.obj_colours;
         index_reg_addr = OBPI;
     }
 
@@ -550,6 +683,8 @@ void palette_data_write(GameBoy *gb, const uint16_t address, const uint8_t value
         *colour &= 0x7FFF; // transparency is never set
     }
 
+    colours[index / 2] = convert_colour(gb, *colour);
+
     const bool auto_incr = (index_reg & PI_AUTO_INCR) >> 7;
 
     if(auto_incr) {
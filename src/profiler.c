@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include "jgbc.h"
+#include "mmu.h"
+#include "cpu.h"
+#include "profiler.h"
+
+static uint32_t current_node(const Profiler *);
+static uint32_t child_node(Profiler *, uint32_t, uint16_t, uint16_t);
+static void enter_routine(GameBoy *, uint16_t);
+static void leave_routines(GameBoy *);
+static bool is_call(uint8_t);
+
+
+void init_profiler(GameBoy *gb) {
+    gb->profiler.is_enabled = false;
+    gb->profiler.rom_cycles = NULL;
+    gb->profiler.ram_cycles = NULL;
+    gb->profiler.nodes = NULL;
+    gb->profiler.node_count = 0;
+    gb->profiler.frames = NULL;
+    gb->profiler.frame_count = 0;
+}
+
+// The counters are kept when stopped, they are only cleared explicitly
+void start_profiler(GameBoy *gb) {
+
+    Profiler *profiler = &gb->profiler;
+
+    if(profiler->rom_cycles == NULL) {
+        profiler->rom_cycles = malloc(sizeof(uint64_t) * gb->cart.rom_size * ROM_BANK_SIZE);
+        profiler->ram_cycles = malloc(sizeof(uint64_t) * PROFILE_RAM_SIZE);
+        profiler->nodes = malloc(sizeof(ProfileNode) * PROFILE_MAX_NODES);
+        profiler->frames = malloc(sizeof(ProfileFrame) * PROFILE_MAX_DEPTH);
+
+        clear_profiler(gb);
+    }
+
+    profiler->is_enabled = true;
+}
+
+void stop_profiler(GameBoy *gb) {
+    gb->profiler.is_enabled = false;
+}
+
+void clear_profiler(GameBoy *gb) {
+
+    Profiler *profiler = &gb->profiler;
+
+    if(profiler->rom_cycles == NULL)
+        return;
+
+    profiler->cycles = 0;
+    profiler->halted_cycles = 0;
+
+    memset(profiler->rom_cycles, 0, sizeof(uint64_t) * gb->cart.rom_size * ROM_BANK_SIZE);
+    memset(profiler->ram_cycles, 0, sizeof(uint64_t) * PROFILE_RAM_SIZE);
+
+    ProfileNode *root = &profiler->nodes[0];
+    memset(root, 0, sizeof(ProfileNode));
+    root->address = PROGRAM_START;
+
+    profiler->node_count = 1;
+    profiler->frame_count = 0;
+}
+
+// Called before each instruction while profiling
+void begin_profile(GameBoy *gb) {
+
+    Profiler *profiler = &gb->profiler;
+    const uint16_t pc = REG(PC);
+
+    if(pc <= ROM00_END)
+        profiler->instr_cycles = &profiler->rom_cycles[pc];
+    else if(pc <= ROMNN_END)
+        profiler->instr_cycles = &profiler->rom_cycles[(uint32_t) gb->mmu.rom_bank * ROM_BANK_SIZE + pc - ROMNN_START];
+    else
+        profiler->instr_cycles = &profiler->ram_cycles[pc - PROFILE_RAM_START];
+
+    profiler->instr_sp = REG(SP);
+    profiler->instr_opcode = SREAD8(pc);
+}
+
+// Called after each instruction while profiling, the cycles of a CALL are counted in the caller
+void end_profile(GameBoy *gb) {
+
+    Profiler *profiler = &gb->profiler;
+    const uint16_t ticks = gb->cpu.ticks;
+
+    *profiler->instr_cycles += ticks;
+    profiler->nodes[current_node(profiler)].cycles += ticks;
+    profiler->cycles += ticks;
+
+    // A conditional call that isn't taken leaves SP as it was
+    if(is_call(profiler->instr_opcode) && REG(SP) == (uint16_t) (profiler->instr_sp - 2))
+        enter_routine(gb, profiler->instr_sp);
+    else
+        leave_routines(gb);
+}
+
+void profile_halted(GameBoy *gb) {
+
+    Profiler *profiler = &gb->profiler;
+    const uint16_t ticks = gb->cpu.ticks;
+
+    profiler->nodes[current_node(profiler)].cycles += ticks;
+    profiler->cycles += ticks;
+    profiler->halted_cycles += ticks;
+}
+
+// Called once the return address is pushed and the PC is at the vector, with SP before the push
+void profile_interrupt(GameBoy *gb, const uint16_t sp) {
+    enter_routine(gb, sp);
+}
+
+static uint32_t current_node(const Profiler *profiler) {
+    return profiler->frame_count == 0 ? 0 : profiler->frames[profiler->frame_count - 1].node;
+}
+
+// Finds or adds the node of the routine under the parent, the parent is used once the tree is full
+static uint32_t child_node(Profiler *profiler, const uint32_t parent, const uint16_t bank, const uint16_t address) {
+
+    uint32_t *link = &profiler->nodes[parent].first_child;
+
+    while(*link != 0) {
+        const ProfileNode *node = &profiler->nodes[*link];
+
+        if(node->address == address && node->bank == bank)
+            return *link;
+
+        link = &profiler->nodes[*link].next_sibling;
+    }
+
+    if(profiler->node_count == PROFILE_MAX_NODES)
+        return parent;
+
+    const uint32_t index = profiler->node_count++;
+    ProfileNode *node = &profiler->nodes[index];
+
+    memset(node, 0, sizeof(ProfileNode));
+    node->bank = bank;
+    node->address = address;
+    node->parent = parent;
+
+    *link = index;
+    return index;
+}
+
+// The PC is at the entry point of the routine
+static void enter_routine(GameBoy *gb, const uint16_t sp) {
+
+    Profiler *profiler = &gb->profiler;
+
+    // Deeper calls are counted in the deepest routine
+    if(profiler->frame_count == PROFILE_MAX_DEPTH)
+        return;
+
+    const uint32_t node = child_node(profiler, current_node(profiler), mapped_bank(gb, REG(PC)), REG(PC));
+    profiler->nodes[node].calls++;
+
+    ProfileFrame *frame = &profiler->frames[profiler->frame_count++];
+    frame->node = node;
+    frame->sp = sp;
+}
+
+// A routine is left once its return address is off the stack
+// This also catches the routines that return by popping the address and jumping
+static void leave_routines(GameBoy *gb) {
+
+    Profiler *profiler = &gb->profiler;
+
+    while(profiler->frame_count > 0 && REG(SP) >= profiler->frames[profiler->frame_count - 1].sp)
+        profiler->frame_count--;
+}
+
+// CALL, conditional CALL and RST
+static bool is_call(const uint8_t opcode) {
+    return opcode == 0xCD || (opcode & 0xE7) == 0xC4 || (opcode & 0xC7) == 0xC7;
+}
@@ -0,0 +1,228 @@
+#include <math.h>
+#include <stdlib.h>
+#include "jgbc.h"
+#include "resampler.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RESAMPLER_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RESAMPLER_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+#define PI 3.14159265358979323846
+
+static void build_coefficients(Resampler *, double);
+static void set_kernel(Resampler *);
+
+static void filter_scalar(const float *, const float *, const float *, const float *, float, float *);
+
+#ifdef RESAMPLER_X86
+static void filter_sse2(const float *, const float *, const float *, const float *, float, float *);
+static void filter_avx2(const float *, const float *, const float *, const float *, float, float *);
+#endif
+
+#ifdef RESAMPLER_NEON
+static void filter_neon(const float *, const float *, const float *, const float *, float, float *);
+#endif
+
+
+void init_resampler(Resampler *resampler) {
+
+    // One extra phase so the interpolation between two phases never wraps
+    resampler->coefficients = calloc((RESAMPLER_PHASES + 1) * RESAMPLER_TAPS, sizeof(float));
+
+    // The history is stored twice so the filter always reads a contiguous window
+    resampler->history[0] = calloc(RESAMPLER_TAPS * 2, sizeof(float));
+    resampler->history[1] = calloc(RESAMPLER_TAPS * 2, sizeof(float));
+    resampler->position = 0;
+    resampler->clock = 0.0f;
+    resampler->step = 1.0f;
+
+    set_kernel(resampler);
+}
+
+// Rebuilds the filter for a new output rate, the step can be adjusted afterwards for rate control
+void set_resampler_rates(Resampler *resampler, const float input_rate, const float output_rate) {
+
+    resampler->input_rate = input_rate;
+    resampler->step = input_rate / output_rate;
+    resampler->clock = 0.0f;
+
+    build_coefficients(resampler, RESAMPLER_CUTOFF * output_rate / input_rate);
+}
+
+// Feeds one input sample, returns true and writes a stereo output sample when one is due
+bool resample(Resampler *resampler, const float left, const float right, float *out) {
+
+    const uint8_t position = resampler->position;
+
+    resampler->history[0][position] = left;
+    resampler->history[0][position + RESAMPLER_TAPS] = left;
+    resampler->history[1][position] = right;
+    resampler->history[1][position + RESAMPLER_TAPS] = right;
+    resampler->position = (position + 1) % RESAMPLER_TAPS;
+
+    resampler->clock += 1.0f;
+
+    if(resampler->clock < resampler->step)
+        return false;
+
+    resampler->clock -= resampler->step;
+
+    // The output sample lies this far (0 to 1 input samples) before the newest input
+    const float phase = resampler->clock * RESAMPLER_PHASES;
+    const int index = phase < RESAMPLER_PHASES ? (int) phase : RESAMPLER_PHASES - 1;
+    const float *coefficients = resampler->coefficients + index * RESAMPLER_TAPS;
+
+    resampler->filter(
+        resampler->history[0] + resampler->position,
+        resampler->history[1] + resampler->position,
+        coefficients,
+        coefficients + RESAMPLER_TAPS,
+        phase - index,
+        out
+    );
+
+    return true;
+}
+
+// Blackman windowed sinc, each phase normalised to unity gain
+static void build_coefficients(Resampler *resampler, const double cutoff) {
+
+    for(int phase = 0; phase <= RESAMPLER_PHASES; ++phase) {
+
+        float *row = resampler->coefficients + phase * RESAMPLER_TAPS;
+        double sum = 0.0;
+
+        for(int i = 0; i < RESAMPLER_TAPS; ++i) {
+
+            const double x = i - RESAMPLER_TAPS / 2 + (double) phase / RESAMPLER_PHASES;
+            const double w = 2.0 * PI * x / RESAMPLER_TAPS;
+            const double window = 0.42 + 0.5 * cos(w) + 0.08 * cos(2.0 * w);
+            const double sinc = x == 0.0 ? 1.0 : sin(2.0 * PI * cutoff * x) / (2.0 * PI * cutoff * x);
+
+            row[i] = (float) (window * sinc);
+            sum += row[i];
+        }
+
+        for(int i = 0; i < RESAMPLER_TAPS; ++i)
+            row[i] = (float) (row[i] / sum);
+    }
+}
+
+// Picks the widest filter kernel supported by the host CPU
+static void set_kernel(Resampler *resampler) {
+
+    resampler->filter = &filter_scalar;
+
+#ifdef RESAMPLER_X86
+    if(SDL_HasAVX2())
+        resampler->filter = &filter_avx2;
+    else if(SDL_HasSSE2())
+        resampler->filter = &filter_sse2;
+#endif
+
+#ifdef RESAMPLER_NEON
+    if(SDL_HasNEON())
+        resampler->filter = &filter_neon;
+#endif
+}
+
+// The coefficients are interpolated between the two nearest phases before the dot product
+static void filter_scalar(const float *left, const float *right, const float *a, const float *b, const float fraction, float *out) {
+
+    float sum_left = 0.0f;
+    float sum_right = 0.0f;
+
+    for(int i = 0; i < RESAMPLER_TAPS; ++i) {
+        const float coefficient = a[i] + (b[i] - a[i]) * fraction;
+
+        sum_left += left[i] * coefficient;
+        sum_right += right[i] * coefficient;
+    }
+
+    out[0] = sum_left;
+    out[1] = sum_right;
+}
+
+#ifdef RESAMPLER_X86
+
+TARGET_SSE2 static float sum_sse2(const __m128 value) {
+    const __m128 pairs = _mm_add_ps(value, _mm_movehl_ps(value, value));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 0x55)));
+}
+
+TARGET_SSE2 static void filter_sse2(const float *left, const float *right, const float *a, const float *b, const float fraction, float *out) {
+
+    const __m128 weight = _mm_set1_ps(fraction);
+    __m128 sum_left = _mm_setzero_ps();
+    __m128 sum_right = _mm_setzero_ps();
+
+    for(int i = 0; i < RESAMPLER_TAPS; i += 4) {
+        const __m128 first = _mm_loadu_ps(a + i);
+        const __m128 coefficient = _mm_add_ps(first, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), first), weight));
+
+        sum_left = _mm_add_ps(sum_left, _mm_mul_ps(_mm_loadu_ps(left + i), coefficient));
+        sum_right = _mm_add_ps(sum_right, _mm_mul_ps(_mm_loadu_ps(right + i), coefficient));
+    }
+
+    out[0] = sum_sse2(sum_left);
+    out[1] = sum_sse2(sum_right);
+}
+
+// Same as the SSE2 kernel with 8 taps per iteration, the halves are folded before the final sum
+TARGET_AVX2 static void filter_avx2(const float *left, const float *right, const float *a, const float *b, const float fraction, float *out) {
+
+    const __m256 weight = _mm256_set1_ps(fraction);
+    __m256 sum_left = _mm256_setzero_ps();
+    __m256 sum_right = _mm256_setzero_ps();
+
+    for(int i = 0; i < RESAMPLER_TAPS; i += 8) {
+        const __m256 first = _mm256_loadu_ps(a + i);
+        const __m256 coefficient = _mm256_add_ps(first, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), first), weight));
+
+        sum_left = _mm256_add_ps(sum_left, _mm256_mul_ps(_mm256_loadu_ps(left + i), coefficient));
+        sum_right = _mm256_add_ps(sum_right, _mm256_mul_ps(_mm256_loadu_ps(right + i), coefficient));
+    }
+
+    out[0] = sum_sse2(_mm_add_ps(_mm256_castps256_ps128(sum_left), _mm256_extractf128_ps(sum_left, 1)));
+    out[1] = sum_sse2(_mm_add_ps(_mm256_castps256_ps128(sum_right), _mm256_extractf128_ps(sum_right, 1)));
+}
+
+#endif
+
+#ifdef RESAMPLER_NEON
+
+static float sum_neon(const float32x4_t value) {
+    const float32x2_t pairs = vadd_f32(vget_low_f32(value), vget_high_f32(value));
+    return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+}
+
+static void filter_neon(const float *left, const float *right, const float *a, const float *b, const float fraction, float *out) {
+
+    float32x4_t sum_left = vdupq_n_f32(0.0f);
+    float32x4_t sum_right = vdupq_n_f32(0.0f);
+
+    for(int i = 0; i < RESAMPLER_TAPS; i += 4) {
+        const float32x4_t first = vld1q_f32(a + i);
+        const float32x4_t coefficient = vmlaq_n_f32(first, vsubq_f32(vld1q_f32(b + i), first), fraction);
+
+        sum_left = vmlaq_f32(sum_left, vld1q_f32(left + i), coefficient);
+        sum_right = vmlaq_f32(sum_right, vld1q_f32(right + i), coefficient);
+    }
+
+    out[0] = sum_neon(sum_left);
+    out[1] = sum_neon(sum_right);
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include "jgbc.h"
+#include "macro.h"
+#include "tile.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TILE_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TILE_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+static void decode_scalar(const TileRow *, uint8_t, uint32_t *);
+
+#ifdef TILE_X86
+static void decode_sse2(const TileRow *, uint8_t, uint32_t *);
+static void decode_avx2(const TileRow *, uint8_t, uint32_t *);
+#endif
+
+#ifdef TILE_NEON
+static void decode_neon(const TileRow *, uint8_t, uint32_t *);
+#endif
+
+
+// Picks the widest tile decoder supported by the host CPU
+void set_tile_decoder(GameBoy *gb) {
+
+    gb->ppu.tile_decoder = &decode_scalar;
+
+#ifdef TILE_X86
+    if(SDL_HasAVX2())
+        gb->ppu.tile_decoder = &decode_avx2;
+    else if(SDL_HasSSE2())
+        gb->ppu.tile_decoder = &decode_sse2;
+#endif
+
+#ifdef TILE_NEON
+    if(SDL_HasNEON())
+        gb->ppu.tile_decoder = &decode_neon;
+#endif
+}
+
+// Mirrors a bitplane byte, used for horizontally flipped tiles
+uint8_t reverse_tile_byte(uint8_t data) {
+    data = (data & 0xF0) >> 4 | (data & 0x0F) << 4;
+    data = (data & 0xCC) >> 2 | (data & 0x33) << 2;
+    data = (data & 0xAA) >> 1 | (data & 0x55) << 1;
+
+    return data;
+}
+
+static void decode_scalar(const TileRow *rows, const uint8_t count, uint32_t *out) {
+
+    for(uint8_t i = 0; i < count; ++i) {
+        const TileRow row = rows[i];
+
+        for(uint8_t px = 0; px < TILE_WIDTH; ++px) {
+            const uint8_t bit = 7 - px;
+            const uint8_t colour_num = GET_BIT(row.low, bit) | (GET_BIT(row.high, bit) << 1);
+
+            *out++ = row.palette[colour_num];
+        }
+    }
+}
+
+#ifdef TILE_X86
+
+// Each 32 bit lane selects one pixel, leftmost pixel (bit 7) in the first lane
+// The colour is picked with masks since SSE2 has no blend or shuffle
+TARGET_SSE2 static __m128i select_sse2(const __m128i low, const __m128i high, const __m128i *colours) {
+    const __m128i lower = _mm_or_si128(_mm_and_si128(low, colours[1]), _mm_andnot_si128(low, colours[0]));
+    const __m128i upper = _mm_or_si128(_mm_and_si128(low, colours[3]), _mm_andnot_si128(low, colours[2]));
+
+    return _mm_or_si128(_mm_and_si128(high, upper), _mm_andnot_si128(high, lower));
+}
+
+TARGET_SSE2 static __m128i test_bits_sse2(const uint8_t data, const __m128i bits) {
+    return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(data), bits), bits);
+}
+
+TARGET_SSE2 static void decode_sse2(const TileRow *rows, const uint8_t count, uint32_t *out) {
+
+    const __m128i left_bits = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+    const __m128i right_bits = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+
+    for(uint8_t i = 0; i < count; ++i) {
+        const TileRow row = rows[i];
+
+        const __m128i colours[4] = {
+            _mm_set1_epi32(row.palette[0]),
+            _mm_set1_epi32(row.palette[1]),
+            _mm_set1_epi32(row.palette[2]),
+            _mm_set1_epi32(row.palette[3])
+        };
+
+        const __m128i left = select_sse2(test_bits_sse2(row.low, left_bits), test_bits_sse2(row.high, left_bits), colours);
+        const __m128i right = select_sse2(test_bits_sse2(row.low, right_bits), test_bits_sse2(row.high, right_bits), colours);
+
+        _mm_storeu_si128((__m128i *) (out + i * TILE_WIDTH), left);
+        _mm_storeu_si128((__m128i *) (out + i * TILE_WIDTH + 4), right);
+    }
+}
+
+// Same as the SSE2 decoder but a whole tile row (8 pixels) per store
+TARGET_AVX2 static void decode_avx2(const TileRow *rows, const uint8_t count, uint32_t *out) {
+
+    const __m256i bits = _mm256_set_epi32(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+
+    for(uint8_t i = 0; i < count; ++i) {
+        const TileRow row = rows[i];
+
+        const __m256i low = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(row.low), bits), bits);
+        const __m256i high = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(row.high), bits), bits);
+
+        const __m256i lower = _mm256_blendv_epi8(_mm256_set1_epi32(row.palette[0]), _mm256_set1_epi32(row.palette[1]), low);
+        const __m256i upper = _mm256_blendv_epi8(_mm256_set1_epi32(row.palette[2]), _mm256_set1_epi32(row.palette[3]), low);
+
+        _mm256_storeu_si256((__m256i *) (out + i * TILE_WIDTH), _mm256_blendv_epi8(lower, upper, high));
+    }
+}
+
+#endif
+
+#ifdef TILE_NEON
+
+static uint32x4_t select_neon(const TileRow *row, const uint32x4_t bits) {
+
+    const uint32x4_t low = vtstq_u32(vdupq_n_u32(row->low), bits);
+    const uint32x4_t high = vtstq_u32(vdupq_n_u32(row->high), bits);
+
+    const uint32x4_t lower = vbslq_u32(low, vdupq_n_u32(row->palette[1]), vdupq_n_u32(row->palette[0]));
+    const uint32x4_t upper = vbslq_u32(low, vdupq_n_u32(row->palette[3]), vdupq_n_u32(row->palette[2]));
+
+    return vbslq_u32(high, upper, lower);
+}
+
+static void decode_neon(const TileRow *rows, const uint8_t count, uint32_t *out) {
+
+    static const uint32_t left_values[4] = { 0x80, 0x40, 0x20, 0x10 };
+    static const uint32_t right_values[4] = { 0x08, 0x04, 0x02, 0x01 };
+
+    const uint32x4_t left_bits = vld1q_u32(left_values);
+    const uint32x4_t right_bits = vld1q_u32(right_values);
+
+    for(uint8_t i = 0; i < count; ++i) {
+        vst1q_u32(out + i * TILE_WIDTH, select_neon(&rows[i], left_bits));
+        vst1q_u32(out + i * TILE_WIDTH + 4, select_neon(&rows[i], right_bits));
+    }
+}
+
+#endif
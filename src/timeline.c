@@ -0,0 +1,71 @@
+#include <stdlib.h>
+#include "jgbc.h"
+#include "mmu.h"
+#include "cpu.h"
+#include "ppu.h"
+#include "timeline.h"
+
+
+void init_timeline(GameBoy *gb) {
+    gb->timeline.is_enabled = false;
+    gb->timeline.events = NULL;
+    gb->timeline.count = 0;
+    gb->timeline.dropped = 0;
+    gb->timeline.frame = NULL;
+    gb->timeline.frame_count = 0;
+    gb->timeline.frame_dropped = 0;
+}
+
+// Recording starts with the next frame
+void start_timeline(GameBoy *gb) {
+
+    Timeline *timeline = &gb->timeline;
+
+    if(timeline->events == NULL) {
+        timeline->events = malloc(sizeof(TimelineEvent) * TIMELINE_MAX_EVENTS);
+        timeline->frame = malloc(sizeof(TimelineEvent) * TIMELINE_MAX_EVENTS);
+    }
+
+    timeline->count = 0;
+    timeline->dropped = 0;
+    timeline->is_enabled = true;
+}
+
+// The last complete frame is kept
+void stop_timeline(GameBoy *gb) {
+    gb->timeline.is_enabled = false;
+}
+
+// Called by the hardware while the timeline is enabled
+void log_event(GameBoy *gb, const TimelineEventType type, const uint16_t address, const uint16_t data) {
+
+    Timeline *timeline = &gb->timeline;
+
+    if(timeline->count == TIMELINE_MAX_EVENTS) {
+        timeline->dropped++;
+        return;
+    }
+
+    TimelineEvent *event = &timeline->events[timeline->count++];
+    event->type = type;
+    event->line = SREAD8(LY);
+    event->dot = gb->ppu.scan_clock;
+    event->address = address;
+    event->data = data;
+    event->pc = REG(PC);
+}
+
+// Swaps the recorded frame in as the last complete frame
+void end_timeline_frame(GameBoy *gb) {
+
+    Timeline *timeline = &gb->timeline;
+    TimelineEvent *frame = timeline->frame;
+
+    timeline->frame = timeline->events;
+    timeline->frame_count = timeline->count;
+    timeline->frame_dropped = timeline->dropped;
+
+    timeline->events = frame;
+    timeline->count = 0;
+    timeline->dropped = 0;
+}
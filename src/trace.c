@@ -0,0 +1,335 @@
+#include <stdlib.h>
+#include <string.h>
+#include "jgbc.h"
+#include "mmu.h"
+#include "cpu.h"
+#include "trace.h"
+
+static TraceChunk *current_chunk(GameBoy *);
+static TraceChunk *next_chunk(GameBoy *, uint64_t);
+static void encode_record(TraceChunk *, const TraceRecord *, const TraceRecord *);
+static uint16_t predict_pc(const TraceRecord *);
+static uint8_t fixed_size(uint8_t);
+static void write_chunk(FILE *, const TraceChunk *);
+
+static uint8_t *put_short(uint8_t *, uint16_t);
+static const uint8_t *get_short(const uint8_t *, uint16_t *);
+
+
+void init_trace(GameBoy *gb) {
+    gb->trace.is_recording = false;
+    gb->trace.clock = 0;
+    gb->trace.chunks = NULL;
+    gb->trace.first_chunk = 0;
+    gb->trace.chunk_count = 0;
+    gb->trace.file = NULL;
+}
+
+// Clears the ring and starts recording, the chunks are also written to the file if there is one
+bool start_trace(GameBoy *gb, const char *path) {
+
+    Trace *trace = &gb->trace;
+
+    if(trace->is_recording)
+        stop_trace(gb);
+
+    if(path != NULL) {
+        trace->file = fopen(path, "wb");
+
+        if(trace->file == NULL)
+            return false;
+    }
+
+    if(trace->chunks == NULL) {
+        trace->chunks = calloc(TRACE_CHUNK_COUNT, sizeof(TraceChunk));
+
+        for(uint32_t i = 0; i < TRACE_CHUNK_COUNT; ++i)
+            trace->chunks[i].data = malloc(TRACE_CHUNK_SIZE);
+    }
+
+    trace->clock = 0;
+    trace->first_chunk = 0;
+    trace->chunk_count = 1;
+    trace->chunks[0].clock = 0;
+    trace->chunks[0].count = 0;
+    trace->chunks[0].size = 0;
+
+    trace->is_recording = true;
+    return true;
+}
+
+// The recorded chunks are kept until the next recording starts
+void stop_trace(GameBoy *gb) {
+
+    Trace *trace = &gb->trace;
+    trace->is_recording = false;
+
+    if(trace->file == NULL)
+        return;
+
+    write_chunk(trace->file, current_chunk(gb));
+    fclose(trace->file);
+    trace->file = NULL;
+}
+
+// Called before each instruction while recording
+void record_instr(GameBoy *gb) {
+
+    Trace *trace = &gb->trace;
+
+    // The ticks of the previous step haven't been reset yet, interrupts and halted steps included
+    trace->clock += gb->cpu.ticks;
+
+    if(gb->cpu.is_halted)
+        return;
+
+    TraceRecord record;
+    record.clock = trace->clock;
+    record.pc = REG(PC);
+    record.bank = mapped_bank(gb, REG(PC));
+    record.af = REG(AF);
+    record.bc = REG(BC);
+    record.de = REG(DE);
+    record.hl = REG(HL);
+    record.sp = REG(SP);
+
+    for(uint8_t i = 0; i < 4; ++i)
+        record.memory[i] = SREAD8(REG(PC) + i);
+
+    TraceChunk *chunk = current_chunk(gb);
+
+    if(chunk->size + TRACE_MAX_RECORD_SIZE > TRACE_CHUNK_SIZE)
+        chunk = next_chunk(gb, record.clock);
+
+    encode_record(chunk, &trace->last, &record);
+    trace->last = record;
+}
+
+// Oldest first
+uint32_t trace_chunk_count(const GameBoy *gb) {
+    return gb->trace.chunks == NULL ? 0 : gb->trace.chunk_count;
+}
+
+const TraceChunk *trace_chunk(const GameBoy *gb, const uint32_t index) {
+    return &gb->trace.chunks[(gb->trace.first_chunk + index) % TRACE_CHUNK_COUNT];
+}
+
+// Writes the records of the chunk, returns how many there are
+// Fewer than the chunk's count if a record runs past its size, a file can be truncated or corrupt
+uint32_t decode_trace_chunk(const TraceChunk *chunk, TraceRecord *records) {
+
+    const uint8_t *in = chunk->data;
+    const uint8_t *end = chunk->data + chunk->size;
+    TraceRecord last;
+    memset(&last, 0, sizeof(TraceRecord));
+    last.clock = chunk->clock;
+
+    for(uint32_t i = 0; i < chunk->count; ++i) {
+
+        if(in == end || (*in & ~TRACE_ALL) || end - in < fixed_size(*in))
+            return i;
+
+        TraceRecord *record = &records[i];
+        *record = last;
+
+        const uint8_t mask = *in++;
+
+        if(mask & TRACE_PC)
+            in = get_short(in, &record->pc);
+        else
+            record->pc = predict_pc(&last);
+
+        if(mask & TRACE_BANK)
+            in = get_short(in, &record->bank);
+        if(mask & TRACE_AF)
+            in = get_short(in, &record->af);
+        if(mask & TRACE_BC)
+            in = get_short(in, &record->bc);
+        if(mask & TRACE_DE)
+            in = get_short(in, &record->de);
+        if(mask & TRACE_HL)
+            in = get_short(in, &record->hl);
+        if(mask & TRACE_SP)
+            in = get_short(in, &record->sp);
+
+        memcpy(record->memory, in, 4);
+        in += 4;
+
+        // Variable length, 7 bits per byte
+        uint64_t delta = 0;
+        uint8_t shift = 0;
+
+        do {
+            if(in == end || shift >= 64)
+                return i;
+
+            delta |= (uint64_t) (*in & 0x7F) << shift;
+            shift += 7;
+        }
+        while(*in++ & 0x80);
+
+        record->clock = last.clock + delta;
+        last = *record;
+    }
+
+    return chunk->count;
+}
+
+// Reads a chunk written while recording to a file, the data must hold TRACE_CHUNK_SIZE bytes
+bool read_trace_chunk(FILE *file, TraceChunk *chunk) {
+
+    uint8_t header[16];
+
+    if(fread(header, sizeof(uint8_t), 16, file) != 16)
+        return false;
+
+    chunk->clock = 0;
+    for(int8_t i = 7; i >= 0; --i)
+        chunk->clock = chunk->clock << 8 | header[i];
+
+    chunk->count = header[8] | header[9] << 8 | header[10] << 16 | (uint32_t) header[11] << 24;
+    chunk->size = header[12] | header[13] << 8 | header[14] << 16 | (uint32_t) header[15] << 24;
+
+    if(chunk->size > TRACE_CHUNK_SIZE || chunk->count > chunk->size)
+        return false;
+
+    return fread(chunk->data, sizeof(uint8_t), chunk->size, file) == chunk->size;
+}
+
+void format_doctor_line(const TraceRecord *record, char *line) {
+    snprintf(
+        line,
+        TRACE_DOCTOR_LINE_SIZE,
+        "A:%02X F:%02X B:%02X C:%02X D:%02X E:%02X H:%02X L:%02X SP:%04X PC:%04X PCMEM:%02X,%02X,%02X,%02X",
+        record->af >> 8, record->af & 0xFF,
+        record->bc >> 8, record->bc & 0xFF,
+        record->de >> 8, record->de & 0xFF,
+        record->hl >> 8, record->hl & 0xFF,
+        record->sp,
+        record->pc,
+        record->memory[0], record->memory[1], record->memory[2], record->memory[3]
+    );
+}
+
+static TraceChunk *current_chunk(GameBoy *gb) {
+    return (TraceChunk *) trace_chunk(gb, gb->trace.chunk_count - 1);
+}
+
+// Closes the current chunk, the oldest one is reused once the ring is full
+static TraceChunk *next_chunk(GameBoy *gb, const uint64_t clock) {
+
+    Trace *trace = &gb->trace;
+
+    if(trace->file != NULL)
+        write_chunk(trace->file, current_chunk(gb));
+
+    if(trace->chunk_count == TRACE_CHUNK_COUNT)
+        trace->first_chunk = (trace->first_chunk + 1) % TRACE_CHUNK_COUNT;
+    else
+        trace->chunk_count++;
+
+    TraceChunk *chunk = current_chunk(gb);
+    chunk->clock = clock;
+    chunk->count = 0;
+    chunk->size = 0;
+
+    return chunk;
+}
+
+// The first record of a chunk is stored in full so every chunk decodes on its own
+static void encode_record(TraceChunk *chunk, const TraceRecord *last, const TraceRecord *record) {
+
+    uint8_t *out = chunk->data + chunk->size;
+    uint8_t mask = TRACE_ALL;
+    uint64_t delta = 0;
+
+    if(chunk->count > 0) {
+        mask = 0;
+        mask |= record->pc != predict_pc(last) ? TRACE_PC : 0;
+        mask |= record->bank != last->bank ? TRACE_BANK : 0;
+        mask |= record->af != last->af ? TRACE_AF : 0;
+        mask |= record->bc != last->bc ? TRACE_BC : 0;
+        mask |= record->de != last->de ? TRACE_DE : 0;
+        mask |= record->hl != last->hl ? TRACE_HL : 0;
+        mask |= record->sp != last->sp ? TRACE_SP : 0;
+
+        delta = record->clock - last->clock;
+    }
+    else
+        chunk->clock = record->clock;
+
+    *out++ = mask;
+
+    if(mask & TRACE_PC)
+        out = put_short(out, record->pc);
+    if(mask & TRACE_BANK)
+        out = put_short(out, record->bank);
+    if(mask & TRACE_AF)
+        out = put_short(out, record->af);
+    if(mask & TRACE_BC)
+        out = put_short(out, record->bc);
+    if(mask & TRACE_DE)
+        out = put_short(out, record->de);
+    if(mask & TRACE_HL)
+        out = put_short(out, record->hl);
+    if(mask & TRACE_SP)
+        out = put_short(out, record->sp);
+
+    memcpy(out, record->memory, 4);
+    out += 4;
+
+    do {
+        *out++ = (delta & 0x7F) | (delta > 0x7F ? 0x80 : 0);
+        delta >>= 7;
+    }
+    while(delta > 0);
+
+    chunk->size = out - chunk->data;
+    chunk->count++;
+}
+
+// Address following the instruction of a record
+static uint16_t predict_pc(const TraceRecord *record) {
+    return record->pc + decode_instr(record->memory).length;
+}
+
+// Little endian header (clock, count, size) followed by the data
+static void write_chunk(FILE *file, const TraceChunk *chunk) {
+
+    uint8_t header[16];
+
+    for(uint8_t i = 0; i < 8; ++i)
+        header[i] = (chunk->clock >> (i * 8)) & 0xFF;
+
+    for(uint8_t i = 0; i < 4; ++i) {
+        header[8 + i] = (chunk->count >> (i * 8)) & 0xFF;
+        header[12 + i] = (chunk->size >> (i * 8)) & 0xFF;
+    }
+
+    fwrite(header, sizeof(uint8_t), 16, file);
+    fwrite(chunk->data, sizeof(uint8_t), chunk->size, file);
+}
+
+static uint8_t *put_short(uint8_t *out, const uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+    return out + 2;
+}
+
+// Bytes of a record before its clock delta: the mask, the stored fields and the memory bytes
+static uint8_t fixed_size(const uint8_t mask) {
+
+    uint8_t size = 1 + 4;
+
+    for(uint8_t field = TRACE_PC; field <= TRACE_SP; field <<= 1) {
+        if(mask & field)
+            size += 2;
+    }
+
+    return size;
+}
+
+static const uint8_t *get_short(const uint8_t *in, uint16_t *value) {
+    *value = in[0] | in[1] << 8;
+    return in + 2;
+}